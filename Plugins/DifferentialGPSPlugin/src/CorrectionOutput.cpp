@@ -0,0 +1,259 @@
+/*
+ * CorrectionOutput.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "CorrectionOutput.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+namespace DifferentialGPSPlugin {
+
+static const char *TcpPrefix = "tcp://";
+static const char *UnixPrefix = "unix:";
+
+static const std::chrono::seconds RetryPeriod(1);
+
+// Longest a socket write may block on a stalled receiver
+static const struct timeval SendTimeout = { 1, 0 };
+
+// Longest to wait for a TCP connection, in milliseconds
+static const int ConnectTimeout = 1000;
+
+CorrectionOutput::CorrectionOutput(): _fd(-1), _socket(false) { }
+
+CorrectionOutput::~CorrectionOutput()
+{
+	Close();
+}
+
+void CorrectionOutput::set_Device(const std::string &device)
+{
+	if (device == _device)
+		return;
+
+	Close();
+	_device = device;
+	_error.clear();
+	_lastAttempt = std::chrono::steady_clock::time_point();
+}
+
+void CorrectionOutput::Close()
+{
+	if (_fd >= 0)
+		::close(_fd);
+
+	_fd = -1;
+	_socket = false;
+}
+
+bool CorrectionOutput::Fail(const std::string &what)
+{
+	_error = what + " " + _device + ": " + ::strerror(errno);
+	Close();
+	return false;
+}
+
+bool CorrectionOutput::Connect(const struct sockaddr *addr, socklen_t len)
+{
+	if (::connect(_fd, addr, len) != 0)
+	{
+		if (errno != EINPROGRESS)
+			return false;
+
+		// Do not hold up the writer on an unreachable receiver
+		struct pollfd pfd = { _fd, POLLOUT, 0 };
+		int rc;
+		do
+		{
+			rc = ::poll(&pfd, 1, ConnectTimeout);
+		} while (rc < 0 && errno == EINTR);
+
+		if (rc == 0)
+			errno = ETIMEDOUT;
+		if (rc <= 0)
+			return false;
+
+		int err = 0;
+		socklen_t errLen = sizeof(err);
+		if (::getsockopt(_fd, SOL_SOCKET, SO_ERROR, &err, &errLen) != 0)
+			return false;
+
+		if (err != 0)
+		{
+			errno = err;
+			return false;
+		}
+	}
+
+	// The writes block, up to the send timeout
+	int flags = ::fcntl(_fd, F_GETFL);
+	return flags >= 0 && ::fcntl(_fd, F_SETFL, flags & ~O_NONBLOCK) == 0;
+}
+
+bool CorrectionOutput::Open()
+{
+	if (_fd >= 0)
+		return true;
+
+	if (_device.empty())
+		return false;
+
+	auto now = std::chrono::steady_clock::now();
+	if (_lastAttempt.time_since_epoch().count() && now - _lastAttempt < RetryPeriod)
+		return false;
+
+	_lastAttempt = now;
+
+	if (_device.compare(0, ::strlen(TcpPrefix), TcpPrefix) == 0)
+	{
+		std::string address = _device.substr(::strlen(TcpPrefix));
+		size_t colon = address.rfind(':');
+		if (colon == std::string::npos)
+		{
+			_error = "Missing port in " + _device;
+			return false;
+		}
+
+		struct addrinfo hints;
+		::memset(&hints, 0, sizeof(hints));
+		hints.ai_family = AF_UNSPEC;
+		hints.ai_socktype = SOCK_STREAM;
+
+		struct addrinfo *result = NULL;
+		int rc = ::getaddrinfo(address.substr(0, colon).c_str(), address.substr(colon + 1).c_str(), &hints, &result);
+		if (rc != 0)
+		{
+			_error = "Unable to resolve " + _device + ": " + ::gai_strerror(rc);
+			return false;
+		}
+
+		for (struct addrinfo *ai = result; ai && _fd < 0; ai = ai->ai_next)
+		{
+			_fd = ::socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC | SOCK_NONBLOCK, ai->ai_protocol);
+			if (_fd >= 0 && !Connect(ai->ai_addr, ai->ai_addrlen))
+			{
+				int err = errno;
+				Close();
+				errno = err;
+			}
+		}
+
+		::freeaddrinfo(result);
+		if (_fd < 0)
+			return Fail("Unable to connect to");
+
+		// Each batch of corrections should go out right away
+		int one = 1;
+		::setsockopt(_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+		_socket = true;
+	}
+	else if (_device.compare(0, ::strlen(UnixPrefix), UnixPrefix) == 0)
+	{
+		std::string path = _device.substr(::strlen(UnixPrefix));
+
+		struct sockaddr_un addr;
+		::memset(&addr, 0, sizeof(addr));
+		addr.sun_family = AF_UNIX;
+		if (path.empty() || path.size() >= sizeof(addr.sun_path))
+		{
+			_error = "Invalid socket path " + _device;
+			return false;
+		}
+
+		::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+		_fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		if (_fd < 0 || ::connect(_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+			return Fail("Unable to connect to");
+
+		_socket = true;
+	}
+	else
+	{
+		_fd = ::open(_device.c_str(), O_WRONLY | O_NOCTTY | O_CLOEXEC);
+		if (_fd < 0)
+			return Fail("Unable to open");
+	}
+
+	if (_socket)
+		::setsockopt(_fd, SOL_SOCKET, SO_SNDTIMEO, &SendTimeout, sizeof(SendTimeout));
+
+	_error.clear();
+	return true;
+}
+
+bool CorrectionOutput::Write(const struct iovec *iov, size_t count)
+{
+	if (!Open())
+		return false;
+
+	// A copy to advance past partial writes
+	std::vector<struct iovec> pending(iov, iov + count);
+
+	size_t next = 0;
+	while (next < pending.size())
+	{
+		if (pending[next].iov_len == 0)
+		{
+			next++;
+			continue;
+		}
+
+		size_t num = std::min(pending.size() - next, (size_t)IOV_MAX);
+
+		ssize_t written;
+		if (_socket)
+		{
+			// Do not raise SIGPIPE if the receiver went away
+			struct msghdr msg;
+			::memset(&msg, 0, sizeof(msg));
+			msg.msg_iov = &pending[next];
+			msg.msg_iovlen = num;
+			written = ::sendmsg(_fd, &msg, MSG_NOSIGNAL);
+		}
+		else
+		{
+			written = ::writev(_fd, &pending[next], num);
+		}
+
+		if (written < 0)
+		{
+			if (errno == EINTR)
+				continue;
+
+			return Fail("Unable to write to");
+		}
+
+		size_t n = written;
+		while (next < pending.size() && n >= pending[next].iov_len)
+			n -= pending[next++].iov_len;
+
+		if (n > 0)
+		{
+			pending[next].iov_base = (char *)pending[next].iov_base + n;
+			pending[next].iov_len -= n;
+		}
+	}
+
+	return true;
+}
+
+} /* End namespace DifferentialGPSPlugin */
@@ -0,0 +1,77 @@
+/*
+ * CorrectionOutput.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef CORRECTIONOUTPUT_H_
+#define CORRECTIONOUTPUT_H_
+
+#include <chrono>
+#include <string>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+namespace DifferentialGPSPlugin {
+
+/**
+ * A persistent connection to the GPS receiver that the corrections are
+ * written to.  The device may be:
+ *
+ *   /dev/ttyACM0      A serial port, or any other file
+ *   tcp://host:port   A TCP port of the receiver
+ *   unix:/path        A local stream socket
+ *
+ * The connection is opened on the first write and kept open, and is closed
+ * on any error to be opened again on a later write.  Failed attempts to open
+ * are retried at most once a second, and a TCP connection that is not made
+ * within a second is given up.
+ *
+ * This class is not thread safe.
+ */
+class CorrectionOutput {
+public:
+	CorrectionOutput();
+	virtual ~CorrectionOutput();
+
+	CorrectionOutput(const CorrectionOutput &) = delete;
+	CorrectionOutput &operator=(const CorrectionOutput &) = delete;
+
+	/**
+	 * Change the device, which closes the current connection if it differs
+	 */
+	void set_Device(const std::string &device);
+	const std::string &get_Device() const { return _device; }
+
+	bool isOpen() const { return _fd >= 0; }
+
+	/**
+	 * Write all the buffers in as few system calls as possible
+	 *
+	 * @return False if the data could not all be written
+	 */
+	bool Write(const struct iovec *iov, size_t count);
+
+	/**
+	 * @return The reason for the last failure, or an empty string
+	 */
+	const std::string &get_Error() const { return _error; }
+
+	void Close();
+
+private:
+	std::string _device;
+	std::string _error;
+	int _fd;
+	bool _socket;
+
+	std::chrono::steady_clock::time_point _lastAttempt;
+
+	bool Open();
+	bool Connect(const struct sockaddr *addr, socklen_t len);
+	bool Fail(const std::string &what);
+};
+
+} /* End namespace DifferentialGPSPlugin */
+
+#endif /* CORRECTIONOUTPUT_H_ */
@@ -7,14 +7,19 @@
 
 #define USE_STD_CHRONO
 
+#include "CorrectionOutput.h"
+#include "RtcmFramer.h"
+
 #include <atomic>
+#include <deque>
 #include <FrequencyThrottle.h>
-#include <fstream>
 #include <LocationMessage.h>
 #include <mutex>
 #include <PluginClient.h>
 #include <rtcm/RtcmMessage.h>
+#include <sys/uio.h>
 #include <tmx/j2735_messages/RtcmMessage.hpp>
+#include <vector>
 
 namespace DifferentialGPSPlugin {
 
@@ -42,7 +47,21 @@ private:
 
 	tmx::utils::FrequencyThrottle<int, std::chrono::seconds> _statusThrottle;
 
+	// The rest is guarded by the write lock
+	std::string _version;
+	CorrectionOutput _output;
+	RtcmFramer _framer;
+
+	// The messages of one epoch, to be written together
+	std::vector<RtcmFramer::Frame> _frames;
+	std::deque<tmx::byte_stream> _contents;
+	std::vector<struct iovec> _iov;
+
 	void Handle(tmx::messages::TmxRtcmEncodedMessage &encodedMsg);
+	bool Configure();
+	bool IsRtcm3() const;
+	void Flush();
+	void UpdateStatus();
 };
 
 std::mutex _cfgLock;
@@ -86,12 +105,88 @@ void DifferentialGPSPlugin::OnStateChange(IvpPluginState state) {
 		UpdateConfigSettings();
 }
 
+/**
+ * Take any new configuration.  Must be called with the write lock held.
+ *
+ * @return True if the corrections should be written
+ */
+bool DifferentialGPSPlugin::Configure() {
+	if (_cfgChanged.exchange(false)) {
+		lock_guard<mutex> lock(_cfgLock);
+		if (_version != _rtcmVer || _output.get_Device() != _device)
+			_framer.Reset();
+
+		_version = _rtcmVer;
+		_output.set_Device(_device);
+	}
+
+	return !_output.get_Device().empty() && _doWrite;
+}
+
+/**
+ * @return True if the configured version is RTCM 3, which is framed here
+ */
+bool DifferentialGPSPlugin::IsRtcm3() const {
+	return !_version.empty() && _version[0] == '3';
+}
+
 void DifferentialGPSPlugin::Handle(TmxRtcmEncodedMessage &encodedMsg) {
 	PLOG(logDEBUG1) << "Incoming message " << encodedMsg;
 
-	for (auto iter = encodedMsg.begin(); iter != encodedMsg.end(); iter++) {
-		if (*iter)
-			this->HandleRTCMMessage(**iter, encodedMsg);
+	lock_guard<mutex> lock(_writeLock);
+	if (!Configure())
+		return;
+
+	if (IsRtcm3()) {
+		// The frames are written straight from the payload
+		byte_stream bytes = encodedMsg.get_payload_bytes();
+		_framer.Push(bytes.data(), bytes.size(), _frames);
+	} else {
+		for (auto iter = encodedMsg.begin(); iter != encodedMsg.end(); iter++) {
+			if (*iter)
+				this->HandleRTCMMessage(**iter, encodedMsg);
+		}
+	}
+
+	Flush();
+	UpdateStatus();
+}
+
+/**
+ * Write all the messages collected for this epoch with one system call.
+ * Must be called with the write lock held.
+ */
+void DifferentialGPSPlugin::Flush() {
+	size_t bytes = 0;
+	for (auto &frame: _frames) {
+		_iov.push_back({ (void *)frame.data, frame.size });
+		PLOG(logDEBUG) << "RTCM " << frame.type() << " message of " << frame.size << " bytes";
+	}
+
+	for (auto &iov: _iov)
+		bytes += iov.iov_len;
+
+	if (!_iov.empty()) {
+		PLOG(logDEBUG) << "Writing " << _iov.size() << " messages of " << bytes << " bytes to " << _output.get_Device();
+
+		if (_output.Write(_iov.data(), _iov.size())) {
+			_msgCount += _iov.size();
+			_byteCount += bytes;
+		}
+	}
+
+	_iov.clear();
+	_frames.clear();
+	_contents.clear();
+	_framer.Release();
+}
+
+void DifferentialGPSPlugin::UpdateStatus() {
+	if (_statusThrottle.Monitor(0)) {
+		SetStatus("RTCM Message Written", (uint64_t)_msgCount);
+		SetStatus("RTCM Bytes Written", (uint64_t)_byteCount);
+		SetStatus("RTCM Frames Rejected", _framer.get_CrcErrors());
+		SetStatus("Error", _output.get_Error());
 	}
 }
 
@@ -112,85 +207,79 @@ void DifferentialGPSPlugin::HandleRTCMCorrectionMessage(RtcmMessage &msg, routea
 	PLOG(logDEBUG) << "Received " << msg;
 
 	auto ptr = msg.get_j2735_data();
-	if (ptr) {
-		TmxRtcmEncodedMessage encodedMsg;
-		byte_stream bytes;
-#if SAEJ2735_SPEC < 63
-		switch (ptr->rev) {
-		case RTCM_Revision_rtcmRev2_x:
-		case RTCM_Revision_rtcmRev2_0:
-		case RTCM_Revision_rtcmRev2_1:
-		case RTCM_Revision_rtcmRev2_3:
-				encodedMsg.set_subtype(rtcm::RtcmVersionName(rtcm::RTCM_VERSION::SC10402_3));
-		case RTCM_Revision_rtcmRev3_0:
-		case RTCM_Revision_rtcmRev3_1:
-				encodedMsg.set_subtype(rtcm::RtcmVersionName(rtcm::RTCM_VERSION::SC10403_3));
-		default:
-				encodedMsg.set_subtype(rtcm::RtcmVersionName(rtcm::RTCM_VERSION::UNKNOWN));
-		}
+	if (!ptr)
+		return;
 
-		for (size_t i = 0; i < ptr->rtcmSets.list.count; i++) {
-			for (size_t j = 0; j < ptr->rtcmSets.list.array[i]->payload.size; j++)
-				bytes.push_back(ptr->rtcmSets.list.array[i]->payload.buf[j]);
-		}
+	// Gather the pieces of the message in place
+	vector<pair<const uint8_t *, size_t> > pieces;
+#if SAEJ2735_SPEC < 63
+	for (size_t i = 0; i < ptr->rtcmSets.list.count; i++)
+		pieces.emplace_back(ptr->rtcmSets.list.array[i]->payload.buf, ptr->rtcmSets.list.array[i]->payload.size);
 #else
-		if (ptr->rev != RTCM_Revision_reserved)
-			encodedMsg.set_subtype(rtcm::RtcmVersionName((rtcm::RTCM_VERSION)(ptr->rev)));
-
-		for (size_t i = 0; i < ptr->msgs.list.count; i++) {
-			for (size_t j = 0; j < ptr->msgs.list.array[i]->size; j++)
-				bytes.push_back(ptr->msgs.list.array[i]->buf[j]);
-		}
+	for (size_t i = 0; i < ptr->msgs.list.count; i++)
+		pieces.emplace_back(ptr->msgs.list.array[i]->buf, ptr->msgs.list.array[i]->size);
 #endif
-		encodedMsg.set_payload_bytes(bytes);
-		this->Handle(encodedMsg);
-	}
-}
-
-void DifferentialGPSPlugin::HandleRTCMMessage(TmxRtcmMessage &msg, routeable_message &routeableMsg) {
-	static string ver;
-	static string device;
 
-	if (_cfgChanged) {
-		lock_guard<mutex> lock(_cfgLock);
-		ver = _rtcmVer;
-		device = _device;
-	}
+	{
+		lock_guard<mutex> lock(_writeLock);
+		if (!Configure())
+			return;
 
-	if (device.empty())
-		return;
+		// RTCM 3 frames are validated by the framer, so write them with no copy
+		if (IsRtcm3()) {
+			for (auto &piece: pieces)
+				_framer.Push(piece.first, piece.second, _frames);
 
-	if (!_doWrite)
-		return;
+			Flush();
+			UpdateStatus();
+			return;
+		}
+	}
 
-	PLOG(logDEBUG) << "Received RTCM message " << msg;
+	TmxRtcmEncodedMessage encodedMsg;
+#if SAEJ2735_SPEC < 63
+	switch (ptr->rev) {
+	case RTCM_Revision_rtcmRev2_x:
+	case RTCM_Revision_rtcmRev2_0:
+	case RTCM_Revision_rtcmRev2_1:
+	case RTCM_Revision_rtcmRev2_3:
+			encodedMsg.set_subtype(rtcm::RtcmVersionName(rtcm::RTCM_VERSION::SC10402_3));
+			break;
+	case RTCM_Revision_rtcmRev3_0:
+	case RTCM_Revision_rtcmRev3_1:
+			encodedMsg.set_subtype(rtcm::RtcmVersionName(rtcm::RTCM_VERSION::SC10403_3));
+			break;
+	default:
+			encodedMsg.set_subtype(rtcm::RtcmVersionName(rtcm::RTCM_VERSION::UNKNOWN));
+	}
+#else
+	if (ptr->rev != RTCM_Revision_reserved)
+		encodedMsg.set_subtype(rtcm::RtcmVersionName((rtcm::RTCM_VERSION)(ptr->rev)));
+#endif
 
-	string err = "";
-	if (msg.is_Valid() && msg.get_VersionName() == ver) {
-		byte_stream bytes = msg.get_contents();
+	size_t size = 0;
+	for (auto &piece: pieces)
+		size += piece.second;
 
-		PLOG(logDEBUG) << "Writing " << bytes.size() << " bytes to " << device;
+	byte_stream bytes;
+	bytes.reserve(size);
+	for (auto &piece: pieces)
+		bytes.insert(bytes.end(), piece.first, piece.first + piece.second);
 
-		lock_guard<mutex> lock(_writeLock);
-		ofstream out;
-		out.open(device.c_str(), ios::binary | ios::out);
-		out.write((const char *)bytes.data(), bytes.size());
-
-		if (out.fail()) {
-			err = "Failed to write RTCM " + ::to_string(msg.get_MessageType()) +
-					" message";
-		} else {
-			_msgCount++;
-			_byteCount += bytes.size();
-		}
+	encodedMsg.set_payload_bytes(bytes);
+	this->Handle(encodedMsg);
+}
 
-		out.close();
-	}
+/**
+ * Queue a decoded message to be written with the rest of its epoch.  Must be
+ * called with the write lock held, and followed by Flush().
+ */
+void DifferentialGPSPlugin::HandleRTCMMessage(TmxRtcmMessage &msg, routeable_message &routeableMsg) {
+	PLOG(logDEBUG) << "Received RTCM message " << msg;
 
-	if (_statusThrottle.Monitor(0)) {
-		SetStatus("RTCM Message Written", (uint64_t)_msgCount);
-		SetStatus("RTCM Bytes Written", (uint64_t)_byteCount);
-		SetStatus("Error", err);
+	if (msg.is_Valid() && msg.get_VersionName() == _version) {
+		_contents.push_back(msg.get_contents());
+		_iov.push_back({ _contents.back().data(), _contents.back().size() });
 	}
 }
 
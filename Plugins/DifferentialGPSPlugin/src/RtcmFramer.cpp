@@ -0,0 +1,197 @@
+/*
+ * RtcmFramer.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "RtcmFramer.h"
+
+#include <algorithm>
+
+namespace DifferentialGPSPlugin {
+
+constexpr uint8_t RtcmFramer::Preamble;
+constexpr size_t RtcmFramer::HeaderSize;
+constexpr size_t RtcmFramer::CrcSize;
+constexpr size_t RtcmFramer::MaxLength;
+
+/**
+ * Build the byte-wise lookup table for the CRC-24Q polynomial 0x1864CFB
+ */
+static const uint32_t *Crc24qTable()
+{
+	static uint32_t table[256];
+	static bool init = [] {
+		for (uint32_t i = 0; i < 256; i++)
+		{
+			uint32_t crc = i << 16;
+			for (int bit = 0; bit < 8; bit++)
+			{
+				crc <<= 1;
+				if (crc & 0x1000000)
+					crc ^= 0x1864CFB;
+			}
+
+			table[i] = crc & 0xFFFFFF;
+		}
+
+		return true;
+	}();
+
+	(void)init;
+	return table;
+}
+
+/**
+ * @return The total size of the frame with the given header, or zero if the header is not valid
+ */
+static size_t FrameSize(const uint8_t *header)
+{
+	if (header[0] != RtcmFramer::Preamble || (header[1] & 0xFC))
+		return 0;
+
+	return RtcmFramer::HeaderSize + (((header[1] & 0x03) << 8) | header[2]) + RtcmFramer::CrcSize;
+}
+
+static bool Valid(const uint8_t *frame, size_t size)
+{
+	const uint8_t *crc = frame + size - RtcmFramer::CrcSize;
+	return RtcmFramer::Crc24q(frame, size - RtcmFramer::CrcSize) ==
+			(((uint32_t)crc[0] << 16) | ((uint32_t)crc[1] << 8) | crc[2]);
+}
+
+uint16_t RtcmFramer::Frame::type() const
+{
+	if (size < HeaderSize + 2 + CrcSize)
+		return 0;
+
+	return (data[HeaderSize] << 4) | (data[HeaderSize + 1] >> 4);
+}
+
+uint32_t RtcmFramer::Crc24q(const uint8_t *data, size_t len, uint32_t crc)
+{
+	static const uint32_t *table = Crc24qTable();
+
+	for (size_t i = 0; i < len; i++)
+		crc = ((crc << 8) & 0xFFFFFF) ^ table[((crc >> 16) ^ data[i]) & 0xFF];
+
+	return crc;
+}
+
+void RtcmFramer::Push(const uint8_t *data, size_t len, std::vector<Frame> &frames)
+{
+	size_t used = 0;
+	if (!_partial.empty())
+		used = Complete(data, len, frames);
+
+	if (used < len)
+		Scan(data + used, len - used, frames);
+}
+
+void RtcmFramer::Release()
+{
+	_gathered.clear();
+}
+
+void RtcmFramer::Reset()
+{
+	_discarded += _partial.size();
+	_partial.clear();
+	_gathered.clear();
+}
+
+void RtcmFramer::Scan(const uint8_t *data, size_t len, std::vector<Frame> &frames)
+{
+	size_t i = 0;
+	while (i < len)
+	{
+		if (data[i] != Preamble)
+		{
+			i++;
+			_discarded++;
+			continue;
+		}
+
+		if (len - i < HeaderSize)
+			break;
+
+		size_t size = FrameSize(data + i);
+		if (size == 0)
+		{
+			i++;
+			_discarded++;
+			continue;
+		}
+
+		if (len - i < size)
+			break;
+
+		if (!Valid(data + i, size))
+		{
+			// Look for the next preamble inside the bad frame
+			i++;
+			_discarded++;
+			_crcErrors++;
+			continue;
+		}
+
+		frames.push_back(Frame { data + i, size });
+		_frames++;
+		i += size;
+	}
+
+	// Keep the start of the frame that runs past the chunk
+	_partial.assign(data + i, data + len);
+}
+
+size_t RtcmFramer::Complete(const uint8_t *data, size_t len, std::vector<Frame> &frames)
+{
+	size_t used = 0;
+	while (!_partial.empty())
+	{
+		size_t need = _partial.size() < HeaderSize ? HeaderSize : FrameSize(_partial.data());
+		if (need > 0 && _partial.size() < need)
+		{
+			size_t n = std::min(need - _partial.size(), len - used);
+			_partial.insert(_partial.end(), data + used, data + used + n);
+			used += n;
+
+			if (_partial.size() < need)
+				return used;
+
+			// Check the header before waiting on the rest of the frame
+			if (need == HeaderSize)
+				continue;
+		}
+
+		if (need > 0 && Valid(_partial.data(), need))
+		{
+			_gathered.push_back(std::move(_partial));
+			_partial.clear();
+
+			frames.push_back(Frame { _gathered.back().data(), need });
+			_frames++;
+			return used;
+		}
+
+		if (need > 0)
+			_crcErrors++;
+
+		// Not a frame, so rescan what was kept, past this preamble
+		std::vector<uint8_t> kept(_partial.begin() + 1, _partial.end());
+		_partial.clear();
+		_discarded++;
+
+		std::vector<Frame> found;
+		Scan(kept.data(), kept.size(), found);
+		for (auto &frame: found)
+		{
+			_gathered.emplace_back(frame.data, frame.data + frame.size);
+			frames.push_back(Frame { _gathered.back().data(), frame.size });
+		}
+	}
+
+	return used;
+}
+
+} /* End namespace DifferentialGPSPlugin */
@@ -0,0 +1,89 @@
+/*
+ * RtcmFramer.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef RTCMFRAMER_H_
+#define RTCMFRAMER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace DifferentialGPSPlugin {
+
+/**
+ * Incremental parser for the RTCM 3 transport layer.
+ *
+ * Each frame is the 0xD3 preamble, six reserved bits and a 10 bit length,
+ * the message itself and a 24 bit CRC-24Q over everything before it.  The
+ * framer accepts the data in chunks of any size, skips anything that is not
+ * a valid frame, and returns each valid frame exactly as it was received.
+ *
+ * Frames that lie wholly within a chunk are returned in place, without any
+ * copy.  Only a frame split across chunks is gathered into a buffer of the
+ * framer, which stays valid until the next call to Release().
+ */
+class RtcmFramer {
+public:
+	static constexpr uint8_t Preamble = 0xD3;
+	static constexpr size_t HeaderSize = 3;
+	static constexpr size_t CrcSize = 3;
+	static constexpr size_t MaxLength = 1023;
+
+	struct Frame {
+		const uint8_t *data;
+		size_t size;
+
+		/**
+		 * @return The 12 bit message number
+		 */
+		uint16_t type() const;
+	};
+
+	/**
+	 * @return The CRC-24Q of the given bytes
+	 */
+	static uint32_t Crc24q(const uint8_t *data, size_t len, uint32_t crc = 0);
+
+	/**
+	 * Parse the next chunk of the stream, and add any complete and valid frames
+	 * to the list.  The returned frames point into the chunk or into the framer,
+	 * so the chunk must not change until the frames are used.
+	 */
+	void Push(const uint8_t *data, size_t len, std::vector<Frame> &frames);
+
+	/**
+	 * Free the buffers of the gathered frames that were returned
+	 */
+	void Release();
+
+	/**
+	 * Drop any partial frame, e.g. when the source changes
+	 */
+	void Reset();
+
+	uint64_t get_Frames() const { return _frames; }
+	uint64_t get_CrcErrors() const { return _crcErrors; }
+	uint64_t get_Discarded() const { return _discarded; }
+
+private:
+	// The start of a frame that did not fit in the last chunk
+	std::vector<uint8_t> _partial;
+
+	// Frames gathered from more than one chunk
+	std::deque<std::vector<uint8_t> > _gathered;
+
+	uint64_t _frames = 0;
+	uint64_t _crcErrors = 0;
+	uint64_t _discarded = 0;
+
+	void Scan(const uint8_t *data, size_t len, std::vector<Frame> &frames);
+	size_t Complete(const uint8_t *data, size_t len, std::vector<Frame> &frames);
+};
+
+} /* End namespace DifferentialGPSPlugin */
+
+#endif /* RTCMFRAMER_H_ */
@@ -0,0 +1,116 @@
+/*
+ * DioRailInput.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "DioRailInput.h"
+
+#include <fstream>
+#include <wdt_dio.h>
+
+#include <PluginLog.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include <aiousb.h>
+#ifdef __cplusplus
+}
+#endif
+
+using namespace std;
+using namespace tmx::utils;
+
+namespace HRIStatusPlugin {
+
+bool WdtDioRailInput::IsPresent()
+{
+	static int present = -1;
+	if (present < 0)
+	{
+		// Same check as lsmod, without starting a shell
+		present = 0;
+
+		ifstream modules("/proc/modules");
+		string line;
+		while (getline(modules, line))
+		{
+			if (line.compare(0, 8, "wdt_dio ") == 0)
+			{
+				present = 1;
+				break;
+			}
+		}
+	}
+
+	return present > 0;
+}
+
+bool WdtDioRailInput::Open()
+{
+	return InitDIO();
+}
+
+bool WdtDioRailInput::GetPinState(int pinNumber)
+{
+	return DIReadLine(pinNumber);
+}
+
+bool AiousbRailInput::Open()
+{
+	unsigned long resultCode = AIOUSB_Init();
+	if (resultCode != 0)
+	{
+		PLOG(logDEBUG) << "AIOUSB_Init returned " << resultCode;
+		return false;
+	}
+
+	_open = true;
+	return true;
+}
+
+void AiousbRailInput::Close()
+{
+	if (_open)
+		AIOUSB_Exit();
+
+	_open = false;
+}
+
+bool AiousbRailInput::GetPinState(int pinNumber)
+{
+	bool state = false;
+
+	DIOBuf* readBuffer = NewDIOBuf(16);
+	unsigned long result = DIO_ReadIntoDIOBuf(diFirst, readBuffer);
+	if(result == 0)
+	{
+		char *pinStatusString = DIOBufToString(readBuffer);
+		PLOG(logDEBUG)  << "The status of pin " << pinNumber << " is: " << (int)pinStatusString[GetBufferPosition(pinNumber)];
+		state = (pinStatusString[GetBufferPosition(pinNumber)] == '1');
+	}
+	else
+	{
+		PLOG(logINFO) << "Error reading the pin";
+	}
+
+	DeleteDIOBuf(readBuffer);
+	return state;
+}
+
+int AiousbRailInput::GetBufferPosition(int pin)
+{
+	int position = 0;
+	if (pin < 8)
+	{
+		position = 23 - pin;
+	}
+	else
+	{
+		position = 31 - pin + 8;
+	}
+	return position;
+}
+
+} /* namespace HRIStatusPlugin */
@@ -0,0 +1,51 @@
+/*
+ * DioRailInput.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef DIORAILINPUT_H_
+#define DIORAILINPUT_H_
+
+#include "RailInput.h"
+
+namespace HRIStatusPlugin {
+
+/**
+ * Rail signal read from the digital inputs of a POC-351VTC through the
+ * WDT_DIO driver.
+ */
+class WdtDioRailInput: public RailInput {
+public:
+	std::string get_Type() const { return "POC-351VTC Device"; }
+	bool Open();
+	bool GetPinState(int pinNumber);
+
+	/**
+	 * @return True if the wdt_dio kernel module is loaded
+	 */
+	static bool IsPresent();
+};
+
+/**
+ * Rail signal read from the digital inputs of an ESP box through AIOUSB.
+ */
+class AiousbRailInput: public RailInput {
+public:
+	AiousbRailInput(): _open(false) {}
+	virtual ~AiousbRailInput() { Close(); }
+
+	std::string get_Type() const { return "ESP Box"; }
+	bool Open();
+	void Close();
+	bool GetPinState(int pinNumber);
+
+private:
+	bool _open;
+
+	int GetBufferPosition(int pin);
+};
+
+} /* namespace HRIStatusPlugin */
+
+#endif /* DIORAILINPUT_H_ */
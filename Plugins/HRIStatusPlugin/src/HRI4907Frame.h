@@ -0,0 +1,149 @@
+/*
+ * HRI4907Frame.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef HRI4907FRAME_H_
+#define HRI4907FRAME_H_
+
+#include "HRICrc.h"
+
+#include <cstring>
+
+namespace HRIStatusPlugin {
+
+/**
+ * Pre-encoded ATCS 4907 (HRI state) keep-alive frame.
+ *
+ * Only the message number, sequence number and state bytes change from one
+ * frame to the next, so the CRC states over the static bytes that precede
+ * them are calculated once and each new frame only runs the CRCs over the
+ * remaining tail of the covered range.
+ */
+class HRI4907Frame {
+public:
+	static constexpr size_t Size = 54;
+
+	// Byte offsets of the fields within the frame
+	static constexpr size_t MessageNumberOffset = 26;
+	static constexpr size_t HriOffset = 32;
+	static constexpr size_t SequenceNumberOffset = 38;
+	static constexpr size_t StateOffset = 45;
+	static constexpr size_t Crc16Offset = 48;
+	static constexpr size_t VitalCrcOffset = 50;
+
+	// The vital CRC starts at the address lengths
+	static constexpr size_t VitalOffset = 10;
+
+	// RHBW=1, RSO=1, VAS=2, LTI=0, VP=0
+	static constexpr uint8_t DefaultState = 0xe0;
+
+	HRI4907Frame(): _messageNumber(2), _sequenceNumber(0)
+	{
+		static const uint8_t tmpl[Size] = {
+				0xff, 0xff, 0xf5, 0xff, 0x00, 0x32, //framing and length
+				0x21, 0x00, 0x00, 0x00, 0xee, //type and address lengths
+				0x73, 0x4a, 0x1a, 0x2a, 0xaa, 0xaa, 0xa1, //destination address
+				0x7a, 0x51, 0x1a, 0x2a, 0xaa, 0xa1, 0xa1, //source address
+				0x00, //fixed
+				0x00, //message number shifted left 1
+				0x02, 0x03, //vital
+				0x13, 0x2b, //label (4907)
+				0x01, //version
+				//HRI message
+				0x12, //HRI message length
+				0x00, 0x00, 0x00, 0x00, 0x00, //timestamp
+				0x00, 0x00, 0x00, 0x00, //sequence number
+				0x13, 0x2b, //label (4907)
+				0x03, //version and vital
+				//4907 message
+				0x00, //state
+				0x00, 0x00, //reserved
+				//crc
+				0x00, 0x00, //crc16
+				0x00, 0x00, 0x00, 0x00 //vital crc
+		};
+
+		memcpy(_bytes, tmpl, Size);
+		_bytes[StateOffset] = DefaultState;
+
+		// Everything before the first variable field is fixed
+		_crc16Prefix = GetCrc16(0xffff, &_bytes[HriOffset], SequenceNumberOffset - HriOffset);
+		_crc32Prefix = GetCrc32(0, &_bytes[VitalOffset], MessageNumberOffset - VitalOffset);
+
+		Encode();
+	}
+
+	/**
+	 * @return The encoded frame bytes
+	 */
+	const uint8_t *data() const { return _bytes; }
+
+	/**
+	 * @return The number of bytes in the frame
+	 */
+	size_t size() const { return Size; }
+
+	uint8_t get_MessageNumber() const { return _messageNumber; }
+	uint32_t get_SequenceNumber() const { return _sequenceNumber; }
+
+	/**
+	 * Set the crossing state byte for subsequent frames
+	 */
+	void set_State(uint8_t state)
+	{
+		if (_bytes[StateOffset] != state)
+		{
+			_bytes[StateOffset] = state;
+			Encode();
+		}
+	}
+
+	/**
+	 * Advance to the next frame in the sequence.  The message number
+	 * increments by two and the sequence number by one.
+	 */
+	void Next()
+	{
+		_messageNumber += 2;
+		_sequenceNumber++;
+		Encode();
+	}
+
+private:
+	uint8_t _bytes[Size];
+
+	uint8_t _messageNumber;
+	uint32_t _sequenceNumber;
+
+	uint16_t _crc16Prefix;
+	uint32_t _crc32Prefix;
+
+	void Encode()
+	{
+		_bytes[MessageNumberOffset] = _messageNumber;
+
+		// Sequence number is big-endian
+		_bytes[SequenceNumberOffset] = (uint8_t)((_sequenceNumber >> 24) & 0xff);
+		_bytes[SequenceNumberOffset + 1] = (uint8_t)((_sequenceNumber >> 16) & 0xff);
+		_bytes[SequenceNumberOffset + 2] = (uint8_t)((_sequenceNumber >> 8) & 0xff);
+		_bytes[SequenceNumberOffset + 3] = (uint8_t)(_sequenceNumber & 0xff);
+
+		// CRC-16 covers the 16 byte HRI message, stored little-endian
+		uint16_t crc16 = ~GetCrc16(_crc16Prefix, &_bytes[SequenceNumberOffset], Crc16Offset - SequenceNumberOffset);
+		_bytes[Crc16Offset] = (uint8_t)(crc16 & 0x00ff);
+		_bytes[Crc16Offset + 1] = (uint8_t)((crc16 >> 8) & 0x00ff);
+
+		// Vital CRC-32 covers the 40 bytes from the address lengths through the CRC-16, stored little-endian
+		uint32_t crc32 = GetCrc32(_crc32Prefix, &_bytes[MessageNumberOffset], VitalCrcOffset - MessageNumberOffset);
+		_bytes[VitalCrcOffset] = (uint8_t)(crc32 & 0x000000ff);
+		_bytes[VitalCrcOffset + 1] = (uint8_t)((crc32 >> 8) & 0x000000ff);
+		_bytes[VitalCrcOffset + 2] = (uint8_t)((crc32 >> 16) & 0x000000ff);
+		_bytes[VitalCrcOffset + 3] = (uint8_t)((crc32 >> 24) & 0x000000ff);
+	}
+};
+
+} /* namespace HRIStatusPlugin */
+
+#endif /* HRI4907FRAME_H_ */
@@ -0,0 +1,169 @@
+/*
+ * HRI4907Writer.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "HRI4907Writer.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <PluginLog.h>
+
+using namespace std;
+using namespace tmx::utils;
+
+namespace HRIStatusPlugin {
+
+HRI4907Writer::HRI4907Writer(): _period(1000), _fd(-1), _openFailed(false), _written(HRI4907Frame::Size), _thread(NULL)
+{
+}
+
+HRI4907Writer::~HRI4907Writer()
+{
+	Stop();
+}
+
+void HRI4907Writer::Start(const string &portName, chrono::milliseconds period)
+{
+	Stop();
+
+	_portName = portName;
+	_period = period;
+	_running = true;
+	_thread = new thread(&HRI4907Writer::Run, this);
+}
+
+void HRI4907Writer::Stop()
+{
+	if (!_thread)
+		return;
+
+	{
+		lock_guard<mutex> lock(_lock);
+		_running = false;
+	}
+	_cv.notify_all();
+
+	if (_thread->joinable())
+		_thread->join();
+
+	delete _thread;
+	_thread = NULL;
+
+	Close();
+}
+
+bool HRI4907Writer::Open()
+{
+	if (_fd >= 0)
+		return true;
+
+	// The reader configures the line settings on its own descriptor.  This one
+	// only needs to be non-blocking for writes.
+	_fd = open(_portName.c_str(), O_WRONLY | O_NOCTTY | O_NONBLOCK);
+	if (_fd < 0)
+	{
+		// Only report the first of a series of failures
+		if (!_openFailed)
+			PLOG(logERROR) << "Error opening serial port " << _portName << " for 4907 messages: " << strerror(errno);
+
+		_openFailed = true;
+		return false;
+	}
+
+	_openFailed = false;
+
+	// Start on a frame boundary
+	_written = HRI4907Frame::Size;
+	return true;
+}
+
+void HRI4907Writer::Close()
+{
+	if (_fd >= 0)
+		close(_fd);
+
+	_fd = -1;
+}
+
+/**
+ * Write out whatever remains of the current frame, waiting for the port to
+ * drain up to the given deadline.
+ *
+ * @return True if the frame was completely written
+ */
+bool HRI4907Writer::Flush(chrono::steady_clock::time_point deadline)
+{
+	while (_running && _written < _frame.size())
+	{
+		ssize_t rc = write(_fd, _frame.data() + _written, _frame.size() - _written);
+		if (rc > 0)
+		{
+			_written += rc;
+			if (_written < _frame.size())
+				_shortWrites++;
+			continue;
+		}
+
+		if (rc < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+		{
+			PLOG(logERROR) << "Error sending 4907 message: " << strerror(errno);
+			_errors++;
+			Close();
+			return false;
+		}
+
+		auto remaining = chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now());
+		if (remaining.count() <= 0)
+			return false;
+
+		struct pollfd pfd;
+		pfd.fd = _fd;
+		pfd.events = POLLOUT;
+		pfd.revents = 0;
+		poll(&pfd, 1, remaining.count());
+	}
+
+	return _written >= _frame.size();
+}
+
+void HRI4907Writer::Run()
+{
+	PLOG(logINFO) << "Sending 4907 messages to " << _portName << " every " << _period.count() << " ms";
+
+	auto next = chrono::steady_clock::now();
+
+	while (_running)
+	{
+		if (Open())
+		{
+			// Finish any frame left over from a stalled write before starting the next
+			if (_written >= _frame.size())
+				_written = 0;
+
+			if (Flush(next + _period))
+			{
+				_framesSent++;
+				_frame.Next();
+			}
+			else if (_fd >= 0)
+			{
+				PLOG(logWARNING) << "Serial port stalled sending 4907 message " << _frame.get_SequenceNumber();
+			}
+		}
+
+		next += _period;
+
+		unique_lock<mutex> lock(_lock);
+		_cv.wait_until(lock, next, [this]() { return !_running; });
+	}
+
+	PLOG(logINFO) << "Stopped sending 4907 messages";
+}
+
+} /* namespace HRIStatusPlugin */
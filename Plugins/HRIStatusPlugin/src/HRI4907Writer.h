@@ -0,0 +1,76 @@
+/*
+ * HRI4907Writer.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef HRI4907WRITER_H_
+#define HRI4907WRITER_H_
+
+#include "HRI4907Frame.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace HRIStatusPlugin {
+
+/**
+ * Dedicated writer for the 4907 keep-alive message to the ATCS serial port.
+ *
+ * The writer owns a separate non-blocking descriptor to the port so that a
+ * stalled serial line can never hold up the SPaT broadcast thread.  A frame
+ * that is only partially written is completed before the next one is built,
+ * so the receiver never sees an interleaved or truncated message.
+ */
+class HRI4907Writer {
+public:
+	HRI4907Writer();
+	virtual ~HRI4907Writer();
+
+	/**
+	 * Start sending to the given serial port on the given period
+	 */
+	void Start(const std::string &portName, std::chrono::milliseconds period = std::chrono::milliseconds(1000));
+
+	/**
+	 * Stop the writer thread and close the port
+	 */
+	void Stop();
+
+	bool IsRunning() const { return _running; }
+
+	uint64_t get_FramesSent() const { return _framesSent; }
+	uint64_t get_ShortWrites() const { return _shortWrites; }
+	uint64_t get_Errors() const { return _errors; }
+
+private:
+	void Run();
+	bool Open();
+	void Close();
+	bool Flush(std::chrono::steady_clock::time_point deadline);
+
+	std::string _portName;
+	std::chrono::milliseconds _period;
+
+	int _fd;
+	bool _openFailed;
+	HRI4907Frame _frame;
+	size_t _written;
+
+	std::thread *_thread;
+	std::atomic<bool> _running { false };
+	std::mutex _lock;
+	std::condition_variable _cv;
+
+	std::atomic<uint64_t> _framesSent { 0 };
+	std::atomic<uint64_t> _shortWrites { 0 };
+	std::atomic<uint64_t> _errors { 0 };
+};
+
+} /* namespace HRIStatusPlugin */
+
+#endif /* HRI4907WRITER_H_ */
@@ -0,0 +1,121 @@
+/*
+ * HRICrc.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef HRICRC_H_
+#define HRICRC_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace HRIStatusPlugin {
+
+/**
+ * Lookup tables for the ATCS CRC-16 and the vital CRC-32 used to frame the
+ * 4904 and 4907 serial messages.
+ */
+static const uint16_t crc16_table[256] = {
+	0x0000,0x1189,0x2312,0x329b,0x4624,0x57ad,0x6536,0x74bf,
+	0x8c48,0x9dc1,0xaf5a,0xbed3,0xca6c,0xdbe5,0xe97e,0xf8f7,
+	0x1081,0x0108,0x3393,0x221a,0x56a5,0x472c,0x75b7,0x643e,
+	0x9cc9,0x8d40,0xbfdb,0xae52,0xdaed,0xcb64,0xf9ff,0xe876,
+	0x2102,0x308b,0x0210,0x1399,0x6726,0x76af,0x4434,0x55bd,
+	0xad4a,0xbcc3,0x8e58,0x9fd1,0xeb6e,0xfae7,0xc87c,0xd9f5,
+	0x3183,0x200a,0x1291,0x0318,0x77a7,0x662e,0x54b5,0x453c,
+	0xbdcb,0xac42,0x9ed9,0x8f50,0xfbef,0xea66,0xd8fd,0xc974,
+	0x4204,0x538d,0x6116,0x709f,0x0420,0x15a9,0x2732,0x36bb,
+	0xce4c,0xdfc5,0xed5e,0xfcd7,0x8868,0x99e1,0xab7a,0xbaf3,
+	0x5285,0x430c,0x7197,0x601e,0x14a1,0x0528,0x37b3,0x263a,
+	0xdecd,0xcf44,0xfddf,0xec56,0x98e9,0x8960,0xbbfb,0xaa72,
+	0x6306,0x728f,0x4014,0x519d,0x2522,0x34ab,0x0630,0x17b9,
+	0xef4e,0xfec7,0xcc5c,0xddd5,0xa96a,0xb8e3,0x8a78,0x9bf1,
+	0x7387,0x620e,0x5095,0x411c,0x35a3,0x242a,0x16b1,0x0738,
+	0xffcf,0xee46,0xdcdd,0xcd54,0xb9eb,0xa862,0x9af9,0x8b70,
+	0x8408,0x9581,0xa71a,0xb693,0xc22c,0xd3a5,0xe13e,0xf0b7,
+	0x0840,0x19c9,0x2b52,0x3adb,0x4e64,0x5fed,0x6d76,0x7cff,
+	0x9489,0x8500,0xb79b,0xa612,0xd2ad,0xc324,0xf1bf,0xe036,
+	0x18c1,0x0948,0x3bd3,0x2a5a,0x5ee5,0x4f6c,0x7df7,0x6c7e,
+	0xa50a,0xb483,0x8618,0x9791,0xe32e,0xf2a7,0xc03c,0xd1b5,
+	0x2942,0x38cb,0x0a50,0x1bd9,0x6f66,0x7eef,0x4c74,0x5dfd,
+	0xb58b,0xa402,0x9699,0x8710,0xf3af,0xe226,0xd0bd,0xc134,
+	0x39c3,0x284a,0x1ad1,0x0b58,0x7fe7,0x6e6e,0x5cf5,0x4d7c,
+	0xc60c,0xd785,0xe51e,0xf497,0x8028,0x91a1,0xa33a,0xb2b3,
+	0x4a44,0x5bcd,0x6956,0x78df,0x0c60,0x1de9,0x2f72,0x3efb,
+	0xd68d,0xc704,0xf59f,0xe416,0x90a9,0x8120,0xb3bb,0xa232,
+	0x5ac5,0x4b4c,0x79d7,0x685e,0x1ce1,0x0d68,0x3ff3,0x2e7a,
+	0xe70e,0xf687,0xc41c,0xd595,0xa12a,0xb0a3,0x8238,0x93b1,
+	0x6b46,0x7acf,0x4854,0x59dd,0x2d62,0x3ceb,0x0e70,0x1ff9,
+	0xf78f,0xe606,0xd49d,0xc514,0xb1ab,0xa022,0x92b9,0x8330,
+	0x7bc7,0x6a4e,0x58d5,0x495c,0x3de3,0x2c6a,0x1ef1,0x0f78
+};
+
+static const uint32_t crc32_table[256] = {
+	0x00000000L, 0x6b6f1b22L, 0x578f860fL, 0x3ce09d2dL, 0x2e4ebc55L, 0x4521a777L, 0x79c13a5aL, 0x12ae2178L,
+	0x5c9d78aaL, 0x37f26388L, 0x0b12fea5L, 0x607de587L, 0x72d3c4ffL, 0x19bcdfddL, 0x255c42f0L, 0x4e3359d2L,
+	0x386b411fL, 0x53045a3dL, 0x6fe4c710L, 0x048bdc32L, 0x1625fd4aL, 0x7d4ae668L, 0x41aa7b45L, 0x2ac56067L,
+	0x64f639b5L, 0x0f992297L, 0x3379bfbaL, 0x5816a498L, 0x4ab885e0L, 0x21d79ec2L, 0x1d3703efL, 0x765818cdL,
+	0x70d6823eL, 0x1bb9991cL, 0x27590431L, 0x4c361f13L, 0x5e983e6bL, 0x35f72549L, 0x0917b864L, 0x6278a346L,
+	0x2c4bfa94L, 0x4724e1b6L, 0x7bc47c9bL, 0x10ab67b9L, 0x020546c1L, 0x696a5de3L, 0x558ac0ceL, 0x3ee5dbecL,
+	0x48bdc321L, 0x23d2d803L, 0x1f32452eL, 0x745d5e0cL, 0x66f37f74L, 0x0d9c6456L, 0x317cf97bL, 0x5a13e259L,
+	0x1420bb8bL, 0x7f4fa0a9L, 0x43af3d84L, 0x28c026a6L, 0x3a6e07deL, 0x51011cfcL, 0x6de181d1L, 0x068e9af3L,
+	0x60fcb437L, 0x0b93af15L, 0x37733238L, 0x5c1c291aL, 0x4eb20862L, 0x25dd1340L, 0x193d8e6dL, 0x7252954fL,
+	0x3c61cc9dL, 0x570ed7bfL, 0x6bee4a92L, 0x008151b0L, 0x122f70c8L, 0x79406beaL, 0x45a0f6c7L, 0x2ecfede5L,
+	0x5897f528L, 0x33f8ee0aL, 0x0f187327L, 0x64776805L, 0x76d9497dL, 0x1db6525fL, 0x2156cf72L, 0x4a39d450L,
+	0x040a8d82L, 0x6f6596a0L, 0x53850b8dL, 0x38ea10afL, 0x2a4431d7L, 0x412b2af5L, 0x7dcbb7d8L, 0x16a4acfaL,
+	0x102a3609L, 0x7b452d2bL, 0x47a5b006L, 0x2ccaab24L, 0x3e648a5cL, 0x550b917eL, 0x69eb0c53L, 0x02841771L,
+	0x4cb74ea3L, 0x27d85581L, 0x1b38c8acL, 0x7057d38eL, 0x62f9f2f6L, 0x0996e9d4L, 0x357674f9L, 0x5e196fdbL,
+	0x28417716L, 0x432e6c34L, 0x7fcef119L, 0x14a1ea3bL, 0x060fcb43L, 0x6d60d061L, 0x51804d4cL, 0x3aef566eL,
+	0x74dc0fbcL, 0x1fb3149eL, 0x235389b3L, 0x483c9291L, 0x5a92b3e9L, 0x31fda8cbL, 0x0d1d35e6L, 0x66722ec4L,
+	0x40a8d825L, 0x2bc7c307L, 0x17275e2aL, 0x7c484508L, 0x6ee66470L, 0x05897f52L, 0x3969e27fL, 0x5206f95dL,
+	0x1c35a08fL, 0x775abbadL, 0x4bba2680L, 0x20d53da2L, 0x327b1cdaL, 0x591407f8L, 0x65f49ad5L, 0x0e9b81f7L,
+	0x78c3993aL, 0x13ac8218L, 0x2f4c1f35L, 0x44230417L, 0x568d256fL, 0x3de23e4dL, 0x0102a360L, 0x6a6db842L,
+	0x245ee190L, 0x4f31fab2L, 0x73d1679fL, 0x18be7cbdL, 0x0a105dc5L, 0x617f46e7L, 0x5d9fdbcaL, 0x36f0c0e8L,
+	0x307e5a1bL, 0x5b114139L, 0x67f1dc14L, 0x0c9ec736L, 0x1e30e64eL, 0x755ffd6cL, 0x49bf6041L, 0x22d07b63L,
+	0x6ce322b1L, 0x078c3993L, 0x3b6ca4beL, 0x5003bf9cL, 0x42ad9ee4L, 0x29c285c6L, 0x152218ebL, 0x7e4d03c9L,
+	0x08151b04L, 0x637a0026L, 0x5f9a9d0bL, 0x34f58629L, 0x265ba751L, 0x4d34bc73L, 0x71d4215eL, 0x1abb3a7cL,
+	0x548863aeL, 0x3fe7788cL, 0x0307e5a1L, 0x6868fe83L, 0x7ac6dffbL, 0x11a9c4d9L, 0x2d4959f4L, 0x462642d6L,
+	0x20546c12L, 0x4b3b7730L, 0x77dbea1dL, 0x1cb4f13fL, 0x0e1ad047L, 0x6575cb65L, 0x59955648L, 0x32fa4d6aL,
+	0x7cc914b8L, 0x17a60f9aL, 0x2b4692b7L, 0x40298995L, 0x5287a8edL, 0x39e8b3cfL, 0x05082ee2L, 0x6e6735c0L,
+	0x183f2d0dL, 0x7350362fL, 0x4fb0ab02L, 0x24dfb020L, 0x36719158L, 0x5d1e8a7aL, 0x61fe1757L, 0x0a910c75L,
+	0x44a255a7L, 0x2fcd4e85L, 0x132dd3a8L, 0x7842c88aL, 0x6aece9f2L, 0x0183f2d0L, 0x3d636ffdL, 0x560c74dfL,
+	0x5082ee2cL, 0x3bedf50eL, 0x070d6823L, 0x6c627301L, 0x7ecc5279L, 0x15a3495bL, 0x2943d476L, 0x422ccf54L,
+	0x0c1f9686L, 0x67708da4L, 0x5b901089L, 0x30ff0babL, 0x22512ad3L, 0x493e31f1L, 0x75deacdcL, 0x1eb1b7feL,
+	0x68e9af33L, 0x0386b411L, 0x3f66293cL, 0x5409321eL, 0x46a71366L, 0x2dc80844L, 0x11289569L, 0x7a478e4bL,
+	0x3474d799L, 0x5f1bccbbL, 0x63fb5196L, 0x08944ab4L, 0x1a3a6bccL, 0x715570eeL, 0x4db5edc3L, 0x26daf6e1L
+};
+
+/**
+ * Continue a CRC-16 calculation over the given bytes.
+ *
+ * @param crc The current CRC state
+ * @param data The bytes to add
+ * @param length The number of bytes
+ * @return The updated CRC state
+ */
+inline uint16_t GetCrc16(uint16_t crc, const uint8_t *data, size_t length)
+{
+	while (length--)
+		crc = (crc >> 8) ^ crc16_table[(crc ^ *data++) & 0xff];
+	return crc;
+}
+
+/**
+ * Continue a vital CRC-32 calculation over the given bytes.
+ *
+ * @param crc The current CRC state
+ * @param data The bytes to add
+ * @param length The number of bytes
+ * @return The updated CRC state
+ */
+inline uint32_t GetCrc32(uint32_t crc, const uint8_t *data, size_t length)
+{
+	while (length--)
+		crc = (crc >> 8) ^ crc32_table[(crc ^ *data++) & 0xffL];
+	return crc;
+}
+
+} /* namespace HRIStatusPlugin */
+
+#endif /* HRICRC_H_ */
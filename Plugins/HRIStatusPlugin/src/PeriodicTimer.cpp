@@ -0,0 +1,219 @@
+/*
+ * PeriodicTimer.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "PeriodicTimer.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <PluginLog.h>
+
+using namespace std;
+using namespace tmx::utils;
+
+#define NS_PER_SEC 1000000000ULL
+
+namespace HRIStatusPlugin {
+
+PeriodicTimer::PeriodicTimer(): _fd(-1), _period(0), _nextDeadline(0)
+{
+	_eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+}
+
+PeriodicTimer::~PeriodicTimer()
+{
+	Stop();
+
+	if (_eventFd >= 0)
+		close(_eventFd);
+}
+
+uint64_t PeriodicTimer::Now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * NS_PER_SEC + ts.tv_nsec;
+}
+
+bool PeriodicTimer::Arm(uint64_t firstNs)
+{
+	uint64_t periodNs = chrono::duration_cast<chrono::nanoseconds>(_period).count();
+
+	struct itimerspec spec;
+	spec.it_value.tv_sec = firstNs / NS_PER_SEC;
+	spec.it_value.tv_nsec = firstNs % NS_PER_SEC;
+	spec.it_interval.tv_sec = periodNs / NS_PER_SEC;
+	spec.it_interval.tv_nsec = periodNs % NS_PER_SEC;
+
+	if (timerfd_settime(_fd, TFD_TIMER_ABSTIME, &spec, NULL) < 0)
+	{
+		PLOG(logERROR) << "Unable to arm periodic timer: " << strerror(errno);
+		return false;
+	}
+
+	_nextDeadline = firstNs;
+	return true;
+}
+
+bool PeriodicTimer::Start(chrono::milliseconds period)
+{
+	Stop();
+
+	if (period.count() <= 0)
+		return false;
+
+	_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+	if (_fd < 0)
+	{
+		PLOG(logERROR) << "Unable to create periodic timer: " << strerror(errno);
+		return false;
+	}
+
+	_period = period;
+	ResetStatistics();
+
+	return Arm(Now() + chrono::duration_cast<chrono::nanoseconds>(period).count());
+}
+
+bool PeriodicTimer::set_Period(chrono::milliseconds period)
+{
+	if (_fd < 0)
+		return Start(period);
+
+	if (period == _period || period.count() <= 0)
+		return true;
+
+	_period = period;
+
+	// Keep the current deadline so the phase carries over
+	return Arm(_nextDeadline);
+}
+
+void PeriodicTimer::Stop()
+{
+	if (_fd >= 0)
+		close(_fd);
+
+	_fd = -1;
+}
+
+uint64_t PeriodicTimer::Acknowledge()
+{
+	uint64_t expirations = 0;
+	if (_fd < 0)
+		return 0;
+
+	ssize_t rc = read(_fd, &expirations, sizeof(expirations));
+	if (rc != sizeof(expirations))
+		return 0;
+
+	uint64_t now = Now();
+	uint64_t periodNs = chrono::duration_cast<chrono::nanoseconds>(_period).count();
+
+	// The most recent deadline that expired
+	uint64_t deadline = _nextDeadline + (expirations - 1) * periodNs;
+	uint64_t latency = (now > deadline ? now - deadline : 0) / 1000;
+	if (latency > _maxLatency)
+		_maxLatency = latency;
+
+	_nextDeadline = deadline + periodNs;
+
+	_cycles++;
+	if (expirations > 1)
+		_overruns += expirations - 1;
+
+	return expirations;
+}
+
+uint64_t PeriodicTimer::Wait()
+{
+	if (_fd < 0)
+		return 0;
+
+	struct pollfd pfd[2];
+	pfd[0].fd = _fd;
+	pfd[0].events = POLLIN;
+	pfd[1].fd = _eventFd;
+	pfd[1].events = POLLIN;
+
+	while (true)
+	{
+		pfd[0].revents = 0;
+		pfd[1].revents = 0;
+
+		int rc = poll(pfd, _eventFd >= 0 ? 2 : 1, -1);
+		if (rc < 0)
+		{
+			if (errno == EINTR)
+				continue;
+
+			return 0;
+		}
+
+		// A deadline takes precedence over a wake up
+		if (pfd[0].revents & POLLIN)
+			return Acknowledge();
+
+		if (pfd[1].revents & POLLIN)
+		{
+			uint64_t count;
+			if (read(_eventFd, &count, sizeof(count)) == sizeof(count))
+			{
+				_wakeups++;
+				return 0;
+			}
+		}
+	}
+}
+
+void PeriodicTimer::Wake()
+{
+	if (_eventFd < 0)
+		return;
+
+	uint64_t one = 1;
+	if (write(_eventFd, &one, sizeof(one)) != sizeof(one))
+		PLOG(logDEBUG) << "Unable to wake periodic timer: " << strerror(errno);
+}
+
+void PeriodicTimer::ResetStatistics()
+{
+	_cycles = 0;
+	_overruns = 0;
+	_maxLatency = 0;
+	_wakeups = 0;
+}
+
+bool PeriodicTimer::SetRealTimePriority(int priority)
+{
+	struct sched_param param;
+	memset(&param, 0, sizeof(param));
+
+	int policy = SCHED_OTHER;
+	if (priority > 0)
+	{
+		policy = SCHED_FIFO;
+		param.sched_priority = min(priority, sched_get_priority_max(SCHED_FIFO));
+	}
+
+	int rc = pthread_setschedparam(pthread_self(), policy, &param);
+	if (rc != 0)
+	{
+		PLOG(logWARNING) << "Unable to set real-time priority " << priority << ": " << strerror(rc);
+		return false;
+	}
+
+	return true;
+}
+
+} /* namespace HRIStatusPlugin */
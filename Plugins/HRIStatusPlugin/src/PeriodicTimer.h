@@ -0,0 +1,116 @@
+/*
+ * PeriodicTimer.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef PERIODICTIMER_H_
+#define PERIODICTIMER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace HRIStatusPlugin {
+
+/**
+ * Drift-free periodic timer built on a monotonic timerfd armed with absolute
+ * deadlines.  Each cycle is scheduled from the previous deadline rather than
+ * from the end of the work, so processing time does not stretch the period.
+ *
+ * Missed deadlines are counted as overruns instead of being made up with a
+ * burst of back-to-back cycles.
+ *
+ * Another thread may cut a wait short with Wake() to run an extra cycle
+ * without disturbing the phase of the regular deadlines.
+ */
+class PeriodicTimer {
+public:
+	PeriodicTimer();
+	virtual ~PeriodicTimer();
+
+	/**
+	 * Arm the timer with the given period.  The first deadline is one period
+	 * from now.
+	 *
+	 * @return True if the timer was armed
+	 */
+	bool Start(std::chrono::milliseconds period);
+
+	/**
+	 * Change the period, keeping the timer running.  Takes effect from the
+	 * next deadline.
+	 */
+	bool set_Period(std::chrono::milliseconds period);
+
+	std::chrono::milliseconds get_Period() const { return _period; }
+
+	/**
+	 * Disarm the timer and release the descriptor
+	 */
+	void Stop();
+
+	/**
+	 * Block until the next deadline or until woken.
+	 *
+	 * @return The number of periods that elapsed, which is greater than one
+	 * if the caller overran its deadline, or zero if woken before the deadline
+	 */
+	uint64_t Wait();
+
+	/**
+	 * Wake up the thread blocked in Wait() before its deadline.  Safe to call
+	 * from any thread, and multiple calls before the wait returns are merged.
+	 */
+	void Wake();
+
+	/**
+	 * @return The descriptor that becomes readable on each deadline, or -1
+	 */
+	int get_fd() const { return _fd; }
+
+	/**
+	 * Consume the expirations after the descriptor polled readable.
+	 *
+	 * @return The number of periods that elapsed
+	 */
+	uint64_t Acknowledge();
+
+	uint64_t get_Cycles() const { return _cycles; }
+	uint64_t get_Overruns() const { return _overruns; }
+	uint64_t get_Wakeups() const { return _wakeups; }
+
+	/**
+	 * @return The largest delay in microseconds between a deadline and the
+	 * thread waking up for it
+	 */
+	uint64_t get_MaxLatency() const { return _maxLatency; }
+
+	void ResetStatistics();
+
+	/**
+	 * Raise the calling thread to the SCHED_FIFO real-time class.
+	 *
+	 * @param priority The real-time priority 1-99, or 0 for the default scheduler
+	 * @return True if the policy was applied
+	 */
+	static bool SetRealTimePriority(int priority);
+
+private:
+	bool Arm(uint64_t firstNs);
+	uint64_t Now();
+
+	int _fd;
+	int _eventFd;
+	std::chrono::milliseconds _period;
+	uint64_t _nextDeadline;
+
+	std::atomic<uint64_t> _cycles { 0 };
+	std::atomic<uint64_t> _overruns { 0 };
+	std::atomic<uint64_t> _maxLatency { 0 };
+	std::atomic<uint64_t> _wakeups { 0 };
+};
+
+} /* namespace HRIStatusPlugin */
+
+#endif /* PERIODICTIMER_H_ */
@@ -0,0 +1,52 @@
+/*
+ * RailInput.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "RailInput.h"
+#include "DioRailInput.h"
+#include "SerialRailInput.h"
+#include "SimulatedRailInput.h"
+
+#include <boost/algorithm/string.hpp>
+#include <PluginLog.h>
+
+using namespace std;
+using namespace tmx::utils;
+
+namespace HRIStatusPlugin {
+
+RailInput *RailInput::Create(const string &type, const string &portName, const string &scenarioFile)
+{
+	if (type.empty() || boost::iequals(type, "Auto"))
+	{
+		if (!portName.empty())
+			return new SerialRailInput(portName);
+		else if (WdtDioRailInput::IsPresent())
+			return new WdtDioRailInput();
+		else
+			return new AiousbRailInput();
+	}
+	else if (boost::iequals(type, "WDT_DIO"))
+	{
+		return new WdtDioRailInput();
+	}
+	else if (boost::iequals(type, "AIOUSB"))
+	{
+		return new AiousbRailInput();
+	}
+	else if (boost::iequals(type, "Serial"))
+	{
+		return new SerialRailInput(portName);
+	}
+	else if (boost::iequals(type, "Simulated"))
+	{
+		return new SimulatedRailInput(scenarioFile);
+	}
+
+	PLOG(logERROR) << "Unknown rail input type " << type << ", using Auto";
+	return Create("Auto", portName, scenarioFile);
+}
+
+} /* namespace HRIStatusPlugin */
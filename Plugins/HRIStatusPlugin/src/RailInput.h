@@ -0,0 +1,86 @@
+/*
+ * RailInput.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef RAILINPUT_H_
+#define RAILINPUT_H_
+
+#include <chrono>
+#include <functional>
+#include <string>
+
+namespace HRIStatusPlugin {
+
+/**
+ * Abstract source of the rail preemption signal.
+ *
+ * The pin state follows the crossing hardware: high means the crossing is
+ * clear and low means a train is present.  Backends that see the signal
+ * change on their own thread, rather than only when polled, report the change
+ * through the state handler together with the time it was observed, so that
+ * the SPaT loop can react immediately and measure the latency end to end.
+ */
+class RailInput {
+public:
+	typedef std::function<void(bool pinState, std::chrono::steady_clock::time_point when)> StateHandler;
+
+	virtual ~RailInput() {}
+
+	/**
+	 * @return A descriptive name of the backend for logging
+	 */
+	virtual std::string get_Type() const = 0;
+
+	/**
+	 * Connect to the input device
+	 *
+	 * @return True if the device is ready
+	 */
+	virtual bool Open() = 0;
+
+	/**
+	 * Disconnect from the input device
+	 */
+	virtual void Close() {}
+
+	/**
+	 * @param pinNumber The digital input the rail signal is on
+	 * @return True if the pin is high, false otherwise
+	 */
+	virtual bool GetPinState(int pinNumber) = 0;
+
+	/**
+	 * @return True if the input is currently trusted enough to broadcast a SPaT
+	 */
+	virtual bool IsValid() { return true; }
+
+	void set_StateHandler(StateHandler handler) { _stateHandler = handler; }
+
+	/**
+	 * Create the backend for the given input type.  The "Auto" type selects
+	 * the serial ATCS backend if a port name is configured, otherwise the
+	 * WDT_DIO backend if that driver is loaded, otherwise the AIOUSB backend.
+	 *
+	 * @param type One of Auto, WDT_DIO, AIOUSB, Serial or Simulated
+	 * @param portName The serial port for the serial backend
+	 * @param scenarioFile The scripted scenario for the simulated backend
+	 * @return The new backend.  An unknown type is treated as Auto.
+	 */
+	static RailInput *Create(const std::string &type, const std::string &portName, const std::string &scenarioFile);
+
+protected:
+	void OnStateChange(bool pinState, std::chrono::steady_clock::time_point when = std::chrono::steady_clock::now())
+	{
+		if (_stateHandler)
+			_stateHandler(pinState, when);
+	}
+
+private:
+	StateHandler _stateHandler;
+};
+
+} /* namespace HRIStatusPlugin */
+
+#endif /* RAILINPUT_H_ */
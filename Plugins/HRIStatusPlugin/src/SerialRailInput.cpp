@@ -0,0 +1,267 @@
+/*
+ * SerialRailInput.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "SerialRailInput.h"
+#include "HRICrc.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <Clock.h>
+#include <PluginLog.h>
+
+using namespace std;
+using namespace tmx::utils;
+
+namespace HRIStatusPlugin {
+
+// Largest frame the 16 bit length field can describe
+#define MAX_FRAME_SIZE (0xffff + 4)
+#define READ_SIZE 1024
+
+SerialRailInput::SerialRailInput(const string &portName): _portName(portName), _thread(NULL), _dataLength(0), _lastDataTime(0)
+{
+	_buffer.resize(2048);
+}
+
+SerialRailInput::~SerialRailInput()
+{
+	Close();
+}
+
+bool SerialRailInput::Open()
+{
+	Close();
+
+	_stop = false;
+	bool opened = OpenPort();
+
+	// The reader keeps trying to open the port if it is not there yet
+	_thread = new thread(&SerialRailInput::Reader, this);
+	return opened;
+}
+
+void SerialRailInput::Close()
+{
+	_stop = true;
+	if (_thread)
+	{
+		if (_thread->joinable())
+			_thread->join();
+
+		delete _thread;
+		_thread = NULL;
+	}
+
+	if (_fd >= 0)
+		close(_fd);
+
+	_fd = -1;
+}
+
+bool SerialRailInput::GetPinState(int pinNumber)
+{
+	if (_fd >= 0)
+		return _pinState;
+
+	return false;
+}
+
+bool SerialRailInput::OpenPort()
+{
+	int fd = open(_portName.c_str(), O_RDWR | O_NOCTTY | O_SYNC);
+	if (fd < 0)
+	{
+		PLOG(logERROR) << "Error opening serial port " << _portName << ": " << strerror(errno);
+		return false;
+	}
+
+	SetInterfaceAttribs(fd, B115200, 0);  // set speed to 115200 bps, 8n1 (no parity)
+	SetBlocking(fd, 0);                // set no blocking
+
+	_dataLength = 0;
+	_fd = fd;
+	return true;
+}
+
+/**
+ * Function to read serial port and set train present state
+ */
+void SerialRailInput::Reader()
+{
+	while (!_stop)
+	{
+		if (_fd < 0 && !OpenPort())
+		{
+			usleep(100000);
+			continue;
+		}
+
+		uint64_t currentTime = Clock::GetMillisecondsSinceEpoch();
+		if (currentTime - _lastDataTime > _dataTimeoutMS)
+		{
+			_valid = false;
+			_pinState = false;
+		}
+
+		// Read everything available, up to 0.5 seconds for the first bytes
+		while (!_stop)
+		{
+			if (_buffer.size() < _dataLength + READ_SIZE)
+				_buffer.resize(_dataLength + READ_SIZE);
+
+			int n = read(_fd, &_buffer[_dataLength], READ_SIZE);
+			if (n < 0)
+			{
+				PLOG(logERROR) << "Error reading serial port " << _portName << ": " << strerror(errno);
+				close(_fd);
+				_fd = -1;
+			}
+
+			if (n <= 0)
+				break;
+
+			_dataLength += n;
+			Process();
+		}
+
+		usleep(100000); // check 10 times per second
+	}
+}
+
+/**
+ * Parse the complete frames in the buffer and keep any partial frame for the
+ * next read
+ */
+void SerialRailInput::Process()
+{
+	unsigned char *buf = _buffer.data();
+	size_t i = 0;
+
+	while (i < _dataLength)
+	{
+		//possible start of frame
+		if (buf[i] != 255)
+		{
+			i++;
+			continue;
+		}
+
+		//check if we have at least 6 bytes
+		if (_dataLength - i < 6)
+			break;
+
+		//check for header
+		if (!(buf[i+1] == 255 && buf[i+2] == 245 && buf[i+3] == 255))
+		{
+			i++;
+			continue;
+		}
+
+		//get length
+		size_t messageLength = (buf[i+4] * 256) + buf[i+5];
+		if (_dataLength - i < messageLength + 4)
+			break;
+
+		unsigned char *msg = &buf[i];
+
+		//get address lengths
+		uint8_t sourceAddressLen = msg[10] >> 4;
+		uint8_t destAddressLen = msg[10] & 0x0f;
+		uint8_t totalAddressLen = (sourceAddressLen / 2) + (destAddressLen / 2);
+		if (sourceAddressLen % 2 == 1)
+			totalAddressLen++;
+		if (destAddressLen % 2 == 1)
+			totalAddressLen++;
+
+		// The state byte is the last one read, and the vital CRC follows the message
+		if (messageLength > 10 && (size_t)totalAddressLen + 33 < messageLength)
+		{
+			int label = (msg[totalAddressLen+15] * 256) + msg[totalAddressLen+16];
+			if (label == 4904)
+			{
+				uint32_t calculatedCrc = GetCrc32(0, &msg[10], messageLength - 10);
+				uint32_t messageCrc;
+				memcpy(&messageCrc, &msg[messageLength], sizeof(messageCrc));
+
+				PLOG(logDEBUG) << "Got 4904 message, vital crc:" << messageCrc << ", calculated crc:" << calculatedCrc;
+				if (calculatedCrc == messageCrc)
+				{
+					//get WSA bit for crossing 1
+					unsigned char tpd = msg[totalAddressLen+33] & 0x04;
+					PLOG(logDEBUG) << "Got 4904 message, HRI " << (tpd > 0 ? "Active" : "NOT Active");
+
+					_pinState = (tpd == 0);
+					_lastDataTime = Clock::GetMillisecondsSinceEpoch();
+					_valid = true;
+					OnStateChange(_pinState);
+				}
+			}
+		}
+
+		//increment index past message
+		i += messageLength + 4;
+	}
+
+	// A frame never gets longer than the length field allows, so anything
+	// beyond that is garbage
+	if (_dataLength - i > MAX_FRAME_SIZE)
+		i = _dataLength;
+
+	if (i > 0)
+	{
+		memmove(buf, &buf[i], _dataLength - i);
+		_dataLength -= i;
+	}
+}
+
+int SerialRailInput::SetInterfaceAttribs(int fd, int speed, int parity)
+{
+	struct termios tty;
+	memset (&tty, 0, sizeof tty);
+	if (tcgetattr (fd, &tty) != 0)
+		return -1;
+
+	cfsetospeed (&tty, speed);
+	cfsetispeed (&tty, speed);
+
+	tty.c_cflag = (tty.c_cflag & ~CSIZE) | CS8;     // 8-bit chars
+
+	tty.c_iflag = 0;				//no processing
+	tty.c_lflag = 0;                // no signaling chars, no echo,
+	                                // no canonical processing
+	tty.c_oflag = 0;                // no remapping, no delays
+	tty.c_cc[VMIN]  = 0;            // read doesn't block
+	tty.c_cc[VTIME] = 5;            // 0.5 seconds read timeout
+
+	tty.c_cflag |= (CLOCAL | CREAD);// ignore modem controls,
+	                                // enable reading
+	tty.c_cflag &= ~(PARENB | PARODD);      // shut off parity
+	tty.c_cflag |= parity;
+	tty.c_cflag &= ~CSTOPB;
+	tty.c_cflag &= ~CRTSCTS;
+
+	if (tcsetattr (fd, TCSANOW, &tty) != 0)
+		return -1;
+
+	return 0;
+}
+
+void SerialRailInput::SetBlocking(int fd, int should_block)
+{
+	struct termios tty;
+	memset (&tty, 0, sizeof tty);
+	if (tcgetattr (fd, &tty) != 0)
+		return;
+
+	tty.c_cc[VMIN]  = should_block ? 1 : 0;
+	tty.c_cc[VTIME] = 5;            // 0.5 seconds read timeout
+}
+
+} /* namespace HRIStatusPlugin */
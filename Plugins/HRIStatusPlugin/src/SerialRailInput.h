@@ -0,0 +1,68 @@
+/*
+ * SerialRailInput.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef SERIALRAILINPUT_H_
+#define SERIALRAILINPUT_H_
+
+#include "RailInput.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace HRIStatusPlugin {
+
+/**
+ * Rail signal decoded from the ATCS 4904 (HRI status) messages sent by the
+ * crossing controller over a serial port.
+ *
+ * The port may also be a pseudo-terminal, which allows a recorded or
+ * generated 4904 stream to stand in for the crossing controller.
+ */
+class SerialRailInput: public RailInput {
+public:
+	SerialRailInput(const std::string &portName);
+	virtual ~SerialRailInput();
+
+	std::string get_Type() const { return "Serial ATCS " + _portName; }
+	bool Open();
+	void Close();
+	bool GetPinState(int pinNumber);
+
+	/**
+	 * @return False if no valid 4904 message arrived within the data timeout
+	 */
+	bool IsValid() { return _valid; }
+
+	/**
+	 * @param timeout The time in milliseconds without a valid 4904 message before the input is no longer valid
+	 */
+	void set_DataTimeout(double timeout) { _dataTimeoutMS = timeout; }
+
+private:
+	std::string _portName;
+	std::atomic<int> _fd { -1 };
+	std::atomic<double> _dataTimeoutMS { 1500 };
+
+	std::atomic<bool> _valid { true };
+	std::atomic<bool> _pinState { false };
+	std::atomic<bool> _stop { false };
+	std::thread *_thread;
+
+	std::vector<unsigned char> _buffer;
+	size_t _dataLength;
+	uint64_t _lastDataTime;
+
+	bool OpenPort();
+	void Reader();
+	void Process();
+	int SetInterfaceAttribs(int fd, int speed, int parity);
+	void SetBlocking(int fd, int should_block);
+};
+
+} /* namespace HRIStatusPlugin */
+
+#endif /* SERIALRAILINPUT_H_ */
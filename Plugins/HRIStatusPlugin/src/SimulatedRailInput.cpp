@@ -0,0 +1,151 @@
+/*
+ * SimulatedRailInput.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "SimulatedRailInput.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <boost/algorithm/string.hpp>
+
+#include <PluginLog.h>
+
+using namespace std;
+using namespace tmx::utils;
+
+namespace HRIStatusPlugin {
+
+SimulatedRailInput::SimulatedRailInput(const string &scenarioFile):
+		_scenarioFile(scenarioFile), _loopTime(0), _thread(NULL)
+{
+}
+
+SimulatedRailInput::~SimulatedRailInput()
+{
+	Close();
+}
+
+bool SimulatedRailInput::Load()
+{
+	_events.clear();
+	_loopTime = chrono::milliseconds(0);
+
+	if (_scenarioFile.empty())
+		return true;
+
+	ifstream in(_scenarioFile);
+	if (!in)
+	{
+		PLOG(logERROR) << "Unable to open rail scenario file " << _scenarioFile;
+		return false;
+	}
+
+	string line;
+	int lineNumber = 0;
+	while (getline(in, line))
+	{
+		lineNumber++;
+		boost::trim(line);
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		istringstream ss(line);
+		string first, second;
+		ss >> first >> second;
+
+		try
+		{
+			if (boost::iequals(first, "loop"))
+			{
+				_loopTime = chrono::milliseconds(stoull(second));
+			}
+			else if (boost::iequals(second, "present") || boost::iequals(second, "clear"))
+			{
+				Event event;
+				event.time = chrono::milliseconds(stoull(first));
+				event.pinState = boost::iequals(second, "clear");
+				_events.push_back(event);
+			}
+			else
+			{
+				PLOG(logWARNING) << _scenarioFile << ":" << lineNumber << ": Unknown crossing state " << second;
+			}
+		}
+		catch (exception &ex)
+		{
+			PLOG(logWARNING) << _scenarioFile << ":" << lineNumber << ": Invalid time: " << ex.what();
+		}
+	}
+
+	stable_sort(_events.begin(), _events.end(),
+			[](const Event &a, const Event &b) { return a.time < b.time; });
+
+	if (!_events.empty() && _loopTime <= _events.back().time)
+		_loopTime = chrono::milliseconds(0);
+
+	PLOG(logINFO) << "Loaded " << _events.size() << " rail events from " << _scenarioFile;
+	return true;
+}
+
+bool SimulatedRailInput::Open()
+{
+	Close();
+
+	if (!Load())
+		return false;
+
+	_pinState = true;
+	_running = true;
+	_thread = new thread(&SimulatedRailInput::Run, this);
+	return true;
+}
+
+void SimulatedRailInput::Close()
+{
+	if (!_thread)
+		return;
+
+	{
+		lock_guard<mutex> lock(_lock);
+		_running = false;
+	}
+	_cv.notify_all();
+
+	if (_thread->joinable())
+		_thread->join();
+
+	delete _thread;
+	_thread = NULL;
+}
+
+void SimulatedRailInput::Run()
+{
+	auto start = chrono::steady_clock::now();
+
+	while (_running && !_events.empty())
+	{
+		for (size_t i = 0; _running && i < _events.size(); i++)
+		{
+			auto when = start + _events[i].time;
+
+			unique_lock<mutex> lock(_lock);
+			if (_cv.wait_until(lock, when, [this]() { return !_running; }))
+				break;
+			lock.unlock();
+
+			// Report the scheduled time so latency includes the wake up of this thread
+			_pinState = _events[i].pinState;
+			OnStateChange(_events[i].pinState, when);
+		}
+
+		if (_loopTime.count() <= 0)
+			break;
+
+		start += _loopTime;
+	}
+}
+
+} /* namespace HRIStatusPlugin */
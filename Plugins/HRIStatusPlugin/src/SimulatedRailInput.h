@@ -0,0 +1,69 @@
+/*
+ * SimulatedRailInput.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef SIMULATEDRAILINPUT_H_
+#define SIMULATEDRAILINPUT_H_
+
+#include "RailInput.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace HRIStatusPlugin {
+
+/**
+ * Rail signal played back from a scripted scenario file, so the plugin can be
+ * run and timed on a machine without any crossing hardware.
+ *
+ * Each line of the file holds the time in milliseconds from the start of the
+ * scenario and the crossing state at that time, either "present" or "clear".
+ * An optional "loop <ms>" line restarts the scenario after the given time.
+ * Blank lines and lines starting with # are ignored.  For example:
+ *
+ * 		0 clear
+ * 		5000 present
+ * 		25000 clear
+ * 		loop 30000
+ *
+ * The crossing stays clear if no scenario file is given.
+ */
+class SimulatedRailInput: public RailInput {
+public:
+	SimulatedRailInput(const std::string &scenarioFile);
+	virtual ~SimulatedRailInput();
+
+	std::string get_Type() const { return "Simulated " + _scenarioFile; }
+	bool Open();
+	void Close();
+	bool GetPinState(int pinNumber) { return _pinState; }
+
+private:
+	struct Event
+	{
+		std::chrono::milliseconds time;
+		bool pinState;
+	};
+
+	std::string _scenarioFile;
+	std::vector<Event> _events;
+	std::chrono::milliseconds _loopTime;
+
+	std::atomic<bool> _pinState { true };
+	std::atomic<bool> _running { false };
+	std::thread *_thread;
+	std::mutex _lock;
+	std::condition_variable _cv;
+
+	bool Load();
+	void Run();
+};
+
+} /* namespace HRIStatusPlugin */
+
+#endif /* SIMULATEDRAILINPUT_H_ */
@@ -0,0 +1,183 @@
+/*
+ * SpatLoop.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "SpatLoop.h"
+
+#include <bitset>
+#include <thread>
+
+#include <Clock.h>
+
+using namespace std;
+using namespace tmx;
+using namespace tmx::messages;
+using namespace tmx::utils;
+
+namespace HRIStatusPlugin {
+
+void SpatLoop::Configure(const string &intxnName, int intxnId, const vector<pair<int, string> > &lanes)
+{
+	lock_guard<mutex> lock(_lock);
+	_lanes = lanes;
+
+	// Build the static SPaT information
+	message_tree_type &spatTree = _spat.get_storage().get_tree();
+	spatTree.put("SPAT.intersections.IntersectionState.name", intxnName);
+	message_tree_type &isTree = spatTree.get_child_optional("SPAT.intersections.IntersectionState").get();
+	isTree.put("id.id", intxnId);
+	isTree.put("revision", 1);
+	bitset<16> status(0);
+	isTree.put("status", status.to_string());
+	isTree.put("moy", 0);
+	isTree.put("timeStamp", 0);
+}
+
+void SpatLoop::SetTrainComing(bool trainComing, chrono::steady_clock::time_point when)
+{
+	if (_trainComing.exchange(trainComing) != trainComing)
+	{
+		_pendingInputTime = chrono::duration_cast<chrono::nanoseconds>(when.time_since_epoch()).count();
+		_timer.Wake();
+	}
+}
+
+void SpatLoop::UpdateTimestamp(message_document &md)
+{
+	struct timeval tv;
+	Clock::GetTimevalSinceEpoch(Clock::GetMillisecondsSinceEpoch(), tv);
+	struct tm * utctime = gmtime( (const time_t *)&tv.tv_sec );
+
+	// In SPAT, the time stamp is split into minute of the year and millisecond of the minute
+	// Calculate the minute of the year
+	unsigned long long int minOfYear = utctime->tm_min + (utctime->tm_hour * 60) + (utctime->tm_yday * 24 * 60);
+
+	// Calculate the millisecond of the minute
+	unsigned long long int msOfMin = (1000 * utctime->tm_sec) + (tv.tv_usec / 1000);
+
+	// Update the document
+	pugi::xpath_node minOfYearNode = md.select_node("/SPAT/intersections/IntersectionState/moy");
+	minOfYearNode.node().text().set(minOfYear);
+	pugi::xpath_node msOfMinNode = md.select_node("/SPAT/intersections/IntersectionState/timeStamp");
+	msOfMinNode.node().text().set(msOfMin);
+}
+
+void SpatLoop::UpdateMovementState(message_document &md, bool trainComing)
+{
+	pugi::xpath_node intersectionState = md.select_node("//IntersectionState");
+
+	intersectionState.node().remove_child("states");
+
+	pugi :: xml_node states = intersectionState.node().append_child("states");
+
+	lock_guard<mutex> lock(_lock);
+	for(pair<int, string> newState : _lanes)
+	{
+		pugi::xml_node movementState = states.append_child("MovementState");
+		movementState.append_child("signalGroup").append_child(pugi::node_pcdata).set_value(to_string(newState.first).c_str());
+		pugi::xml_node movementEvent = movementState.append_child("state-time-speed").append_child("MovementEvent");
+		pugi::xml_node eventState = movementEvent.append_child("eventState");
+
+		if(trainComing)
+		{
+			if(newState.second == "tracked")
+			{
+				eventState.append_child("protected-Movement-Allowed");
+			}
+			else
+			{
+				eventState.append_child("stop-And-Remain");
+			}
+		}
+		else
+		{
+			if(newState.second == "tracked")
+			{
+				eventState.append_child("stop-And-Remain");
+			}
+			else
+			{
+				eventState.append_child("permissive-Movement-Allowed");
+			}
+		}
+
+		pugi::xml_node timing = movementEvent.append_child("timing");
+		timing.append_child("minEndTime").append_child(pugi::node_pcdata).set_value("32850");
+		timing.append_child("maxEndTime").append_child(pugi::node_pcdata).set_value("32850");
+	}
+}
+
+bool SpatLoop::Build(SpatEncodedMessage &spatEnc)
+{
+	message_container_type copy;
+	{
+		lock_guard<mutex> lock(_lock);
+		copy = _spat;
+	}
+
+	if (copy.get_storage().get_tree().empty())
+		return false;
+
+	SpatMessage spat(copy);
+	message_document md(spat);
+	UpdateTimestamp(md);
+	UpdateMovementState(md, _trainComing);
+	md.flush();
+	spat.flush();
+
+	spatEnc.initialize(spat);
+	spatEnc.set_flags(IvpMsgFlags_RouteDSRC);
+	spatEnc.addDsrcMetadata(172, 0x8002);
+	return true;
+}
+
+void SpatLoop::Run(RailInput &input, Broadcaster broadcast, CycleHandler cycle, function<bool()> running)
+{
+	_timer.Start(chrono::milliseconds(_period));
+	chrono::steady_clock::time_point lastBroadcast;
+
+	while (running())
+	{
+		if (cycle)
+			cycle();
+
+		//always send spat if using analog input method
+		//if using serial data only send SPAT if we got a valid serial message
+		SpatEncodedMessage spatEnc;
+		if (Build(spatEnc) && input.IsValid())
+		{
+			broadcast(spatEnc);
+			lastBroadcast = chrono::steady_clock::now();
+
+			// The first broadcast after a rail state change carries the new state
+			int64_t inputTime = _pendingInputTime.exchange(0);
+			if (inputTime > 0)
+			{
+				uint64_t latency = (chrono::duration_cast<chrono::nanoseconds>(lastBroadcast.time_since_epoch()).count() - inputTime) / 1000;
+				_inputLatency = latency;
+				if (latency > _maxInputLatency)
+					_maxInputLatency = latency;
+
+				if (_latencyHandler)
+					_latencyHandler(latency);
+			}
+		}
+
+		// Sleep until the next absolute deadline so the processing time above does not drift the period
+		_timer.set_Period(chrono::milliseconds(_period));
+		if (_timer.Wait() == 0)
+		{
+			// Woken early by a rail state change.  Send the new state right away,
+			// but no sooner than the minimum interval after the last broadcast.
+			auto holdOff = lastBroadcast + chrono::milliseconds(_minEventInterval) - chrono::steady_clock::now();
+			if (holdOff.count() > 0)
+				this_thread::sleep_for(holdOff);
+		}
+	}
+
+	_timer.Stop();
+}
+
+} /* namespace HRIStatusPlugin */
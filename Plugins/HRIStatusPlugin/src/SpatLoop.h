@@ -0,0 +1,114 @@
+/*
+ * SpatLoop.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef SPATLOOP_H_
+#define SPATLOOP_H_
+
+#include "PeriodicTimer.h"
+#include "RailInput.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <tmx/j2735_messages/SpatMessage.hpp>
+#include <tmx/messages/message_document.hpp>
+
+namespace HRIStatusPlugin {
+
+/**
+ * Builds the SPaT for the crossing and sends it on a fixed period.
+ *
+ * A change of the train state wakes the loop so that the new state is sent
+ * right away, but no sooner than the minimum event interval after the last
+ * SPaT.  A SPaT is only sent while the rail input is valid.  The time from
+ * each state change to the first SPaT that carries it is measured as the
+ * input latency.
+ */
+class SpatLoop {
+public:
+	typedef std::function<void(tmx::messages::SpatEncodedMessage &spatEnc)> Broadcaster;
+	typedef std::function<void()> CycleHandler;
+	typedef std::function<void(uint64_t latency)> LatencyHandler;
+
+	/**
+	 * Set the static SPaT information
+	 *
+	 * @param lanes The signal group and type of each lane, where the type "tracked" is the track
+	 */
+	void Configure(const std::string &intxnName, int intxnId, const std::vector<std::pair<int, std::string> > &lanes);
+
+	void set_Period(std::chrono::milliseconds period) { _period = period.count(); }
+	void set_MinEventInterval(std::chrono::milliseconds interval) { _minEventInterval = interval.count(); }
+
+	/**
+	 * Update the train state.  A change wakes up the loop to send the new
+	 * state immediately.  Safe to call from any thread.
+	 *
+	 * @param when The time the input changed
+	 */
+	void SetTrainComing(bool trainComing, std::chrono::steady_clock::time_point when = std::chrono::steady_clock::now());
+	bool get_TrainComing() const { return _trainComing; }
+
+	/**
+	 * Build and encode the SPaT for the current train state
+	 *
+	 * @return False if the SPaT is not configured yet
+	 */
+	bool Build(tmx::messages::SpatEncodedMessage &spatEnc);
+
+	/**
+	 * Send the SPaT each period until the running check fails
+	 *
+	 * @param input The rail input, which must be valid for the SPaT to be sent
+	 * @param broadcast Sends each SPaT
+	 * @param cycle Called at the start of every cycle, or empty
+	 * @param running Checked at the start of every cycle
+	 */
+	void Run(RailInput &input, Broadcaster broadcast, CycleHandler cycle, std::function<bool()> running);
+
+	/**
+	 * Receive each input latency as it is measured
+	 */
+	void set_LatencyHandler(LatencyHandler handler) { _latencyHandler = handler; }
+
+	/**
+	 * @return The last and the largest time in microseconds from a train state change to the SPaT
+	 */
+	uint64_t get_InputLatency() const { return _inputLatency; }
+	uint64_t get_MaxInputLatency() const { return _maxInputLatency; }
+
+	const PeriodicTimer &get_Timer() const { return _timer; }
+
+private:
+	std::atomic<bool> _trainComing { true };
+	std::atomic<uint64_t> _period { 100 };
+	std::atomic<uint64_t> _minEventInterval { 20 };
+
+	// The static SPaT information and lanes
+	std::mutex _lock;
+	tmx::message_container_type _spat;
+	std::vector<std::pair<int, std::string> > _lanes;
+
+	PeriodicTimer _timer;
+
+	// Input to SPaT latency, from the time a rail state change is seen to the broadcast of the new state
+	std::atomic<int64_t> _pendingInputTime { 0 };
+	std::atomic<uint64_t> _inputLatency { 0 };
+	std::atomic<uint64_t> _maxInputLatency { 0 };
+	LatencyHandler _latencyHandler;
+
+	void UpdateMovementState(tmx::messages::message_document &md, bool trainComing);
+	void UpdateTimestamp(tmx::messages::message_document &md);
+};
+
+} /* namespace HRIStatusPlugin */
+
+#endif /* SPATLOOP_H_ */
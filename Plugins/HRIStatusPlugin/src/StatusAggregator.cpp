@@ -0,0 +1,152 @@
+/*
+ * StatusAggregator.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "StatusAggregator.h"
+
+#include <vector>
+
+#include <PluginLog.h>
+
+using namespace std;
+using namespace tmx::utils;
+
+namespace HRIStatusPlugin {
+
+StatusAggregator::StatusAggregator(chrono::milliseconds flushInterval):
+		_flushInterval(flushInterval), _thread(NULL), _running(false)
+{
+}
+
+StatusAggregator::~StatusAggregator()
+{
+	Stop();
+}
+
+void StatusAggregator::Start()
+{
+	lock_guard<mutex> lock(_lock);
+	if (_thread)
+		return;
+
+	_running = true;
+	_thread = new thread(&StatusAggregator::Run, this);
+}
+
+void StatusAggregator::Stop()
+{
+	{
+		lock_guard<mutex> lock(_lock);
+		if (!_thread)
+			return;
+
+		_running = false;
+	}
+	_cv.notify_all();
+
+	if (_thread->joinable())
+		_thread->join();
+
+	delete _thread;
+	_thread = NULL;
+}
+
+void StatusAggregator::Update(const string &key, const string &value, Publisher publish)
+{
+	lock_guard<mutex> lock(_lock);
+
+	auto pending = _pending.find(key);
+	if (pending == _pending.end())
+	{
+		auto last = _lastPublished.find(key);
+		if (last != _lastPublished.end() && last->second == value)
+		{
+			_suppressed++;
+			return;
+		}
+
+		Pending &p = _pending[key];
+		p.value = value;
+		p.publish = publish;
+	}
+	else
+	{
+		pending->second.value = value;
+		pending->second.publish = publish;
+	}
+}
+
+void StatusAggregator::Reset()
+{
+	lock_guard<mutex> lock(_lock);
+	_lastPublished.clear();
+}
+
+void StatusAggregator::Run()
+{
+	unique_lock<mutex> lock(_lock);
+	while (_running)
+	{
+		_cv.wait_for(lock, _flushInterval, [this]() { return !_running; });
+
+		lock.unlock();
+		Flush();
+		lock.lock();
+	}
+}
+
+void StatusAggregator::Flush()
+{
+	vector<Publisher> batch;
+
+	{
+		lock_guard<mutex> lock(_lock);
+		if (_pending.empty())
+			return;
+
+		batch.reserve(_pending.size());
+		for (auto &p : _pending)
+		{
+			// Record the value before it goes out, so that a change back to the
+			// previous value while publishing is not mistaken for no change
+			auto last = _lastPublished.find(p.first);
+			if (last != _lastPublished.end() && last->second == p.second.value)
+			{
+				_suppressed++;
+				continue;
+			}
+
+			_lastPublished[p.first] = p.second.value;
+			batch.push_back(p.second.publish);
+		}
+
+		_pending.clear();
+	}
+
+	auto start = chrono::steady_clock::now();
+
+	for (auto &publish : batch)
+	{
+		try
+		{
+			publish();
+		}
+		catch (exception &ex)
+		{
+			PLOG(logERROR) << "Unable to publish status: " << ex.what();
+		}
+	}
+
+	_published += batch.size();
+
+	uint64_t elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+	if (elapsed > _maxFlushTime)
+		_maxFlushTime = elapsed;
+
+	if (elapsed > (uint64_t)_flushInterval.count())
+		PLOG(logDEBUG) << "Publishing " << batch.size() << " status values took " << elapsed << " ms";
+}
+
+} /* namespace HRIStatusPlugin */
@@ -0,0 +1,98 @@
+/*
+ * StatusAggregator.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef STATUSAGGREGATOR_H_
+#define STATUSAGGREGATOR_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace HRIStatusPlugin {
+
+/**
+ * Collects status and system configuration updates and publishes them to the
+ * core database from a separate thread, so that a slow database never stalls
+ * the thread making the update.
+ *
+ * Updates to the same key between flushes are merged and only the latest
+ * value is published.  A value that matches the last one published for the
+ * key is dropped.
+ */
+class StatusAggregator {
+public:
+	typedef std::function<void()> Publisher;
+
+	StatusAggregator(std::chrono::milliseconds flushInterval = std::chrono::milliseconds(100));
+	virtual ~StatusAggregator();
+
+	/**
+	 * Start the flush thread
+	 */
+	void Start();
+
+	/**
+	 * Publish anything still pending and stop the flush thread
+	 */
+	void Stop();
+
+	/**
+	 * Queue an update for the key.
+	 *
+	 * @param key A unique key for the value
+	 * @param value The value as a string, used to detect changes
+	 * @param publish The function that publishes the value, called on the flush thread
+	 */
+	void Update(const std::string &key, const std::string &value, Publisher publish);
+
+	/**
+	 * Forget the values already published, so the next update of every key is
+	 * published even if unchanged.  Used when the core database may have lost
+	 * them, such as after the plugin registers again.
+	 */
+	void Reset();
+
+	uint64_t get_Published() const { return _published; }
+	uint64_t get_Suppressed() const { return _suppressed; }
+
+	/**
+	 * @return The longest time in milliseconds spent publishing one batch
+	 */
+	uint64_t get_MaxFlushTime() const { return _maxFlushTime; }
+
+private:
+	struct Pending
+	{
+		std::string value;
+		Publisher publish;
+	};
+
+	std::chrono::milliseconds _flushInterval;
+
+	std::mutex _lock;
+	std::condition_variable _cv;
+	std::map<std::string, Pending> _pending;
+	std::map<std::string, std::string> _lastPublished;
+
+	std::thread *_thread;
+	bool _running;
+
+	std::atomic<uint64_t> _published { 0 };
+	std::atomic<uint64_t> _suppressed { 0 };
+	std::atomic<uint64_t> _maxFlushTime { 0 };
+
+	void Run();
+	void Flush();
+};
+
+} /* namespace HRIStatusPlugin */
+
+#endif /* STATUSAGGREGATOR_H_ */
@@ -0,0 +1,179 @@
+/*
+ * SpatLatencyBenchmark.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "../src/PeriodicTimer.h"
+#include "../src/SimulatedRailInput.h"
+#include "../src/SpatLoop.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include <boost/algorithm/string.hpp>
+
+using namespace std;
+using namespace tmx::messages;
+using namespace HRIStatusPlugin;
+
+typedef std::chrono::steady_clock bench_clock;
+
+static void Usage(const char *name)
+{
+	cerr << "Usage: " << name << " [-d seconds] [-f period] [-m interval] [-t toggle] [-p priority] [-l lanes] [scenario]" << endl;
+	cerr << endl;
+	cerr << "Plays a rail scenario through the simulated rail input and the SPaT loop" << endl;
+	cerr << "of the plugin, and reports the latency from each crossing state change to" << endl;
+	cerr << "the encoded SPaT that carries it.  The SPaT period, the minimum event" << endl;
+	cerr << "interval and the toggle period are in milliseconds.  Without a scenario" << endl;
+	cerr << "file the crossing toggles between present and clear." << endl;
+}
+
+/**
+ * Write a scenario that toggles the crossing on the given period
+ */
+static string ToggleScenario(uint64_t toggle)
+{
+	char name[] = "/tmp/SpatLatencyBenchmark.XXXXXX";
+	int fd = ::mkstemp(name);
+	if (fd < 0)
+		return "";
+	::close(fd);
+
+	ofstream out(name);
+	out << "0 present" << endl;
+	out << toggle << " clear" << endl;
+	out << "loop " << toggle * 2 << endl;
+	return name;
+}
+
+int main(int argc, char *argv[])
+{
+	double duration = 10;
+	uint64_t frequency = 100;
+	uint64_t minEventInterval = 20;
+	uint64_t toggle = 250;
+	int priority = 0;
+	string laneMap = "1:tracked,2:road";
+	string scenarioFile;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-d") == 0 && i + 1 < argc)
+			duration = strtod(argv[++i], NULL);
+		else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc)
+			frequency = strtoull(argv[++i], NULL, 0);
+		else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc)
+			minEventInterval = strtoull(argv[++i], NULL, 0);
+		else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+			toggle = strtoull(argv[++i], NULL, 0);
+		else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc)
+			priority = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc)
+			laneMap = argv[++i];
+		else if (argv[i][0] == '-' || !scenarioFile.empty())
+		{
+			Usage(argv[0]);
+			return 1;
+		}
+		else
+			scenarioFile = argv[i];
+	}
+
+	vector<string> tokens;
+	vector<pair<int, string> > lanes;
+	boost::split(tokens, laneMap, boost::is_any_of(",:"));
+	for (size_t i = 0; i + 1 < tokens.size(); i += 2)
+		lanes.push_back(pair<int, string>(atoi(tokens[i].c_str()), tokens[i + 1]));
+
+	if (duration <= 0 || frequency == 0 || toggle == 0 || lanes.empty())
+	{
+		Usage(argv[0]);
+		return 1;
+	}
+
+	bool generated = scenarioFile.empty();
+	if (generated)
+		scenarioFile = ToggleScenario(toggle);
+
+	SpatLoop spatLoop;
+	spatLoop.Configure("Benchmark", 1, lanes);
+	spatLoop.set_Period(chrono::milliseconds(frequency));
+	spatLoop.set_MinEventInterval(chrono::milliseconds(minEventInterval));
+
+	atomic<uint64_t> changes { 0 };
+
+	SimulatedRailInput railInput(scenarioFile);
+	railInput.set_StateHandler([&](bool pinState, bench_clock::time_point when)
+	{
+		// If the pin is voltage low the train is coming, as in the plugin
+		if (spatLoop.get_TrainComing() != !pinState)
+			changes++;
+		spatLoop.SetTrainComing(!pinState, when);
+	});
+
+	if (!railInput.Open())
+	{
+		cerr << "Unable to open " << scenarioFile << endl;
+		return 1;
+	}
+
+	cerr << "Running " << railInput.get_Type() << " for " << duration << " seconds" << endl;
+
+	vector<double> latencies;
+	spatLoop.set_LatencyHandler([&](uint64_t latency) { latencies.push_back(latency); });
+
+	uint64_t broadcasts = 0;
+	double encodeTime = 0;
+	bench_clock::time_point cycleStart;
+
+	PeriodicTimer::SetRealTimePriority(priority);
+
+	// The same loop the plugin runs, with the broadcast left out
+	bench_clock::time_point stop = bench_clock::now() + chrono::duration_cast<bench_clock::duration>(chrono::duration<double>(duration));
+	spatLoop.Run(railInput,
+			[&](SpatEncodedMessage &)
+			{
+				encodeTime += chrono::duration<double>(bench_clock::now() - cycleStart).count();
+				broadcasts++;
+			},
+			[&]() { cycleStart = bench_clock::now(); },
+			[&]() { return bench_clock::now() < stop; });
+
+	railInput.Close();
+
+	if (generated)
+		::unlink(scenarioFile.c_str());
+
+	printf("%llu state changes, %llu SPaT messages, %.1f us to build and encode each\n",
+			(unsigned long long)changes, (unsigned long long)broadcasts, broadcasts ? encodeTime * 1e6 / broadcasts : 0);
+	printf("SPaT timer: %llu on state change, %llu overruns, %llu us max wake up latency\n",
+			(unsigned long long)spatLoop.get_Timer().get_Wakeups(), (unsigned long long)spatLoop.get_Timer().get_Overruns(),
+			(unsigned long long)spatLoop.get_Timer().get_MaxLatency());
+
+	if (latencies.empty())
+	{
+		printf("No state changes were broadcast\n");
+		return 0;
+	}
+
+	sort(latencies.begin(), latencies.end());
+	double total = 0;
+	for (double latency : latencies)
+		total += latency;
+
+	printf("\n%-14s %10s %10s %10s %10s %10s\n", "", "Mean us", "Min us", "Median us", "99% us", "Max us");
+	printf("%-14s %10.1f %10.1f %10.1f %10.1f %10.1f\n", "Input to SPaT", total / latencies.size(), latencies.front(),
+			latencies[latencies.size() / 2], latencies[(latencies.size() - 1) * 99 / 100], latencies.back());
+
+	return 0;
+}
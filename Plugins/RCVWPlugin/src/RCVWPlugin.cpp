@@ -31,6 +31,7 @@
 #include <TmxMessageManager.h>
 
 #include "HRILocation.h"
+#include "SharedVehicleState.h"
 #include <Conversions.h>
 #include <PluginDataMonitor.h>
 #include <FrequencyThrottle.h>
@@ -140,6 +141,13 @@ private:
 	//VBM Data
 	std::atomic<uint64_t> _lastVBM;
 
+	//Vehicle state shared by the VehicleInterfacePlugin on this host, guarded by the location lock
+	std::string _vehicleStateMemory;
+	VehicleInterfacePlugin::SharedState::Reader _vehicleState;
+	uint64_t _vehicleStateOpened;
+	int _speedSlot;
+	int _accelerationSlot;
+
 	//Warning Queue, lowest to highest priority
 	std::atomic<bool> _availableActive;
 	std::atomic<bool> _approachInformActive;
@@ -212,6 +220,8 @@ private:
 	bool ParseHRILocationJson(cJSON *root);
 	uint64_t GetMsTimeSinceEpoch();
 	bool IsDecelerating();
+	void PollVehicleState(uint64_t currentTime);
+	bool AddVehicleSpeed(double speed, uint64_t speedTime, uint64_t freshTime);
 	bool InHRI(double lat, double lon, double speed, double heading);
 	//bool HRIPreemptionActive();
 	double GetDistanceToCrossing(double lat, double lon, double heading, double& grade);
@@ -291,6 +301,9 @@ RCVWPlugin::RCVWPlugin(std::string name) : TmxMessageManager(name)
 	_prevPrevSpeedVBM = 0;
 	_speedTimeVBM = 0;
 	_prevSpeedTimeVBM = 0;
+	_vehicleStateOpened = 0;
+	_speedSlot = -1;
+	_accelerationSlot = -1;
 
 	_v2AntennaPlacementXMeters = 0.5;
 	_v2AntennaPlacementYMeters = 2.5;
@@ -377,6 +390,18 @@ void RCVWPlugin::UpdateConfigSettings()
 	GetConfigValue("V2 Max Heading Change", _v2MaxHeadingChange);
 	GetConfigValue("V2 Max Ignored Positions", _v2MaxIgnoredPositions);
 
+	string vehicleStateMemory;
+	GetConfigValue<string>("Vehicle State Memory", vehicleStateMemory);
+	{
+		std::lock_guard<mutex> lock(_locationLock);
+		if (vehicleStateMemory != _vehicleStateMemory)
+		{
+			_vehicleStateMemory = vehicleStateMemory;
+			_vehicleState.Close();
+			_vehicleStateOpened = 0;
+		}
+	}
+
 	_v2LocationFrequencyTargetIntervalMS = 1000.0 / _v2MinumumLocationFrequency;
 	_v2LocationFrequencyCurrentIntervalMS = 0;
 	_v2LocationFrequencyCount = 0;
@@ -593,6 +618,7 @@ void RCVWPlugin::HandleLocationMessage(LocationMessage &msg, routeable_message &
 		SetStatus("Location Received", true);
 	}
 	uint64_t currentTime = GetMsTimeSinceEpoch();
+	PollVehicleState(currentTime);
 	uint64_t locationTime = std::stoull(msg.get_Time());
 	_locationReceived = true;
 	locationInterval = locationTime - _lastLocation;
@@ -740,12 +766,11 @@ void RCVWPlugin::HandleVehicleBasicMessage(VehicleBasicMessage &msg, routeable_m
 {
 	std::lock_guard<mutex> lock(_locationLock);
 	uint64_t currentTime = GetMsTimeSinceEpoch();
-	_lastVBM = currentTime;
-	_prevPrevSpeedVBM.exchange(_prevSpeedVBM);
-	_prevSpeedVBM.exchange(_speedVBM);
-	_speedVBM = msg.get_Speed_mps();
-	_prevSpeedTimeVBM.exchange(_speedTimeVBM);
-	_speedTimeVBM = currentTime;
+
+	// Use the time the speed was measured, if the vehicle interface supplies it
+	uint64_t speedTime = msg.get<uint64_t>("SpeedTime", currentTime);
+
+	AddVehicleSpeed(msg.get_Speed_mps(), speedTime, currentTime);
 	_acceleration = msg.get_Acceleration();
 	PLOG(logDEBUG) << std::setprecision(10) << "VBM SPEED, VBM ACCELERATION: " <<  _speedVBM << ", " << _acceleration;
 
@@ -755,6 +780,112 @@ void RCVWPlugin::HandleVehicleBasicMessage(VehicleBasicMessage &msg, routeable_m
 		__speed_mon.check();
 }
 
+/**
+ * Read the latest speed and acceleration straight from the vehicle state
+ * shared memory, if configured, so they are not delayed by the routing of
+ * the Vehicle Basic Message.  The values are used just like those from the
+ * message.  Must be called with the location lock held.
+ *
+ * @param currentTime The current time in milliseconds since the epoch
+ */
+void RCVWPlugin::PollVehicleState(uint64_t currentTime)
+{
+	if (_vehicleStateMemory.empty())
+		return;
+
+	// A restarted VehicleInterfacePlugin creates a new segment, so check the one mapped is still in use
+	if (_vehicleState.isOpen() && currentTime - _vehicleStateOpened >= 1000)
+	{
+		_vehicleStateOpened = currentTime;
+		if (!_vehicleState.isCurrent())
+		{
+			PLOG(logINFO) << "The vehicle state shared memory " << _vehicleStateMemory << " has no writer, opening it again";
+			_vehicleState.Close();
+			_vehicleStateOpened = 0;
+		}
+	}
+
+	if (!_vehicleState.isOpen())
+	{
+		// Try again once a second until the VehicleInterfacePlugin creates it
+		if (currentTime - _vehicleStateOpened < 1000)
+			return;
+
+		_vehicleStateOpened = currentTime;
+		_speedSlot = -1;
+		_accelerationSlot = -1;
+		if (!_vehicleState.Open(_vehicleStateMemory))
+			return;
+
+		PLOG(logINFO) << "Reading the vehicle state from shared memory " << _vehicleStateMemory;
+	}
+
+	// The values may be defined after the segment is created
+	if (_speedSlot < 0)
+		_speedSlot = _vehicleState.Find("Speed");
+	if (_accelerationSlot < 0)
+		_accelerationSlot = _vehicleState.Find("Acceleration");
+
+	VehicleInterfacePlugin::SharedState::Value value;
+	if (_vehicleState.Read(_speedSlot, value))
+	{
+		uint64_t speedTime = value.time / 1000;
+		double speed = value.number();
+
+		string unit = _vehicleState.Unit(_speedSlot);
+		if (unit == "mph")
+			speed *= 0.44704;
+		else if (unit == "kph" || unit == "km/h")
+			speed /= 3.6;
+
+		// Fresh as of the measurement, not the time it was read
+		AddVehicleSpeed(speed, speedTime, speedTime);
+	}
+
+	if (_vehicleState.Read(_accelerationSlot, value))
+		_acceleration = value.number();
+}
+
+/**
+ * Add a speed sample from the vehicle.  The same measurement seen again, or
+ * one older than the last, is not a new sample.  A sample older than the last
+ * by more than the critical message expiration means the clock of the vehicle
+ * interface stepped back, so the speed history is started again from it.
+ * Only a new sample keeps the vehicle speed in use over the location speed.
+ * Must be called with the location lock held.
+ *
+ * @param speed The speed in meters per second
+ * @param speedTime The time the speed was measured in milliseconds since the epoch
+ * @param freshTime The time the sample is fresh as of, in milliseconds since the epoch
+ * @return True if the sample was taken
+ */
+bool RCVWPlugin::AddVehicleSpeed(double speed, uint64_t speedTime, uint64_t freshTime)
+{
+	if (speedTime <= _speedTimeVBM)
+	{
+		if (_speedTimeVBM - speedTime <= _v2CriticalMessageExpiration)
+			return false;
+
+		PLOG(logWARNING) << "Vehicle speed time stepped back " << (_speedTimeVBM - speedTime) << " ms, restarting the speed history";
+		_prevPrevSpeedVBM = speed;
+		_prevSpeedVBM = speed;
+		_speedVBM = speed;
+		_prevSpeedTimeVBM = speedTime;
+		_speedTimeVBM = speedTime;
+		_lastVBM = freshTime;
+		return true;
+	}
+
+	_prevPrevSpeedVBM.exchange(_prevSpeedVBM);
+	_prevSpeedVBM.exchange(_speedVBM);
+	_speedVBM = speed;
+	_prevSpeedTimeVBM.exchange(_speedTimeVBM);
+	_speedTimeVBM = speedTime;
+	if (freshTime > _lastVBM)
+		_lastVBM = freshTime;
+	return true;
+}
+
 /**
  * Function determines if the vehicle is in a HRI or not
  * based on the data acquired from the map message and the
@@ -1168,6 +1299,7 @@ void RCVWPlugin::AlertVehicle_2()
 	float heading;
 	{
 		std::lock_guard<mutex> lock(_locationLock);
+		PollVehicleState(GetMsTimeSinceEpoch());
 		speed = _speed;
 		prevSpeed = _prevSpeed;
 		hdop = _horizontalDOP;
@@ -0,0 +1,112 @@
+/*
+ * ChangeMonitor.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "ChangeMonitor.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+#include <PluginLog.h>
+
+using namespace std;
+using namespace tmx::utils;
+
+namespace VehicleInterfacePlugin {
+
+ChangeMonitor::~ChangeMonitor()
+{
+	Configure("");
+}
+
+void ChangeMonitor::Configure(const string &signals)
+{
+	for (auto &s : _signals)
+		VehicleState::GetState().Watch(s.slot, false);
+
+	_signals.clear();
+	_resolved = 0;
+
+	istringstream in(signals);
+	string token;
+	while (getline(in, token, ','))
+	{
+		Signal s;
+
+		size_t colon = token.find(':');
+		s.name = token.substr(0, colon);
+		s.deadband = (colon == string::npos) ? 0 : fabs(strtod(token.c_str() + colon + 1, NULL));
+
+		// Trim the white space around the name
+		size_t first = s.name.find_first_not_of(" \t");
+		size_t last = s.name.find_last_not_of(" \t");
+		if (first == string::npos)
+			continue;
+		s.name = s.name.substr(first, last - first + 1);
+
+		s.slot = -1;
+		s.sent = false;
+		s.number = 0;
+		s.state = NULL;
+
+		PLOG(logDEBUG) << "Sending on a change of " << s.name << " by more than " << s.deadband;
+		_signals.push_back(s);
+	}
+}
+
+/**
+ * Look up the slots that were not registered before.  Slots keep their names,
+ * so a slot once found does not change.
+ */
+void ChangeMonitor::Resolve()
+{
+	VehicleState &state = VehicleState::GetState();
+	if (state.size() == _resolved)
+		return;
+
+	_resolved = state.size();
+	for (auto &s : _signals)
+	{
+		if (s.slot < 0)
+		{
+			s.slot = state.Find(s.name);
+			state.Watch(s.slot, true);
+		}
+	}
+}
+
+bool ChangeMonitor::Changed()
+{
+	Resolve();
+
+	VehicleState &state = VehicleState::GetState();
+	for (auto &s : _signals)
+	{
+		double number;
+		const string *name;
+		if (!state.Get(s.slot, number, name))
+			continue;
+
+		if (!s.sent)
+			return true;
+
+		if (name != s.state)
+			return true;
+
+		if (!name && fabs(number - s.number) > s.deadband)
+			return true;
+	}
+
+	return false;
+}
+
+void ChangeMonitor::Sent()
+{
+	VehicleState &state = VehicleState::GetState();
+	for (auto &s : _signals)
+		s.sent = state.Get(s.slot, s.number, s.state);
+}
+
+} /* End namespace VehicleInterfacePlugin */
@@ -0,0 +1,71 @@
+/*
+ * ChangeMonitor.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef CHANGEMONITOR_H_
+#define CHANGEMONITOR_H_
+
+#include "VehicleState.h"
+
+#include <string>
+#include <vector>
+
+namespace VehicleInterfacePlugin {
+
+/**
+ * Watches the critical vehicle state values, such as Speed or Brake, for a
+ * change that is worth sending a new Vehicle Basic Message right away.
+ *
+ * Each value is compared against what was last sent.  A number must move by
+ * more than its deadband, and an enumeration state changes whenever the name
+ * changes.  The values are watched in the VehicleState, so a store to any of
+ * them wakes up VehicleState::WaitForChange().
+ */
+class ChangeMonitor {
+public:
+	~ChangeMonitor();
+
+	/**
+	 * Set the values to watch
+	 *
+	 * @param signals A comma-separated list of names, each with an optional
+	 * deadband, e.g. Speed:0.5,Acceleration:0.2,Brake
+	 */
+	void Configure(const std::string &signals);
+
+	/**
+	 * @return True if any watched value has changed since the last Sent()
+	 */
+	bool Changed();
+
+	/**
+	 * Remember the current values as sent
+	 */
+	void Sent();
+
+	bool empty() const { return _signals.empty(); }
+
+private:
+	struct Signal {
+		std::string name;
+		double deadband;
+		int slot;
+
+		bool sent;
+		double number;
+		const std::string *state;
+	};
+
+	std::vector<Signal> _signals;
+
+	// Number of state slots when the missing slots were last looked up
+	size_t _resolved = 0;
+
+	void Resolve();
+};
+
+} /* End namespace VehicleInterfacePlugin */
+
+#endif /* CHANGEMONITOR_H_ */
@@ -0,0 +1,306 @@
+/*
+ * SharedVehicleState.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef SHAREDVEHICLESTATE_H_
+#define SHAREDVEHICLESTATE_H_
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <signal.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace VehicleInterfacePlugin {
+
+/**
+ * Layout of the shared memory segment that the VehicleInterfacePlugin can
+ * export the decoded vehicle state to, so that plugins on the same host may
+ * read the latest values directly instead of waiting for the routed Vehicle
+ * Basic Message.
+ *
+ * The segment is a header followed by a fixed array of slots, one for each
+ * named value.  A slot name and unit are written once, before the slot count
+ * that covers it is published.  The value of each slot is guarded by a
+ * sequence lock, which is odd while the value is written and zero if the
+ * value has never been written.  Readers must retry until they see the same
+ * even sequence before and after reading the value.
+ *
+ * Any change to this layout must increase the version.  This header only
+ * depends on the standard library, so a consumer can include it directly.
+ */
+namespace SharedState {
+
+static constexpr uint32_t Magic = 0x53534956;	// "VISS"
+static constexpr uint16_t Version = 1;
+
+static constexpr size_t MaxSlots = 256;
+static constexpr size_t NameSize = 32;
+static constexpr size_t UnitSize = 16;
+static constexpr size_t StateSize = 32;
+
+// Attempts at a consistent read of a slot before giving up on it
+static constexpr unsigned MaxReadAttempts = 1000;
+
+/**
+ * The value types, which match VehicleState::SlotType
+ */
+enum class ValueType: uint8_t {
+	None = 0,
+	Int,
+	Double,
+	State
+};
+
+struct Slot {
+	std::atomic<uint32_t> seq;
+	std::atomic<uint8_t> type;
+	uint8_t reserved[3];
+
+	std::atomic<int64_t> i;
+	std::atomic<double> d;
+
+	// Measurement time in microseconds since the epoch
+	std::atomic<uint64_t> time;
+
+	// The enumeration state name, truncated and null terminated
+	char state[StateSize];
+
+	// Fixed when the slot is defined
+	char name[NameSize];
+	char unit[UnitSize];
+};
+
+struct Header {
+	// Set last by the writer once the segment is ready, and cleared when closed
+	std::atomic<uint32_t> magic;
+	uint16_t version;
+	uint16_t headerSize;
+	uint32_t slotSize;
+	uint32_t maxSlots;
+
+	// The writer process
+	int32_t pid;
+
+	// Number of slots defined
+	std::atomic<uint32_t> count;
+
+	// Total number of value updates, for a reader to check for any change
+	std::atomic<uint64_t> updates;
+
+	uint8_t reserved[32];
+};
+
+struct Layout {
+	Header header;
+	Slot slots[MaxSlots];
+};
+
+static_assert(sizeof(Header) == 64, "Shared vehicle state header must not change size");
+static_assert(sizeof(Slot) == 112, "Shared vehicle state slot must not change size");
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "Shared vehicle state requires lock free 64 bit atomics");
+
+/**
+ * A consistent copy of one slot value
+ */
+struct Value {
+	ValueType type;
+	int64_t i;
+	double d;
+	uint64_t time;
+	char state[StateSize];
+
+	/**
+	 * @return The value as a number, or zero for an enumeration state
+	 */
+	double number() const
+	{
+		return type == ValueType::Double ? d : type == ValueType::Int ? (double)i : 0;
+	}
+};
+
+/**
+ * Read-only view of the shared vehicle state, for use by other processes
+ */
+class Reader {
+public:
+	Reader() { }
+	~Reader() { Close(); }
+
+	Reader(const Reader &) = delete;
+	Reader &operator=(const Reader &) = delete;
+
+	/**
+	 * Map the named segment, e.g. /tmx-vehicle
+	 *
+	 * @return False if the segment does not exist, has a different layout, or
+	 * its writer is gone
+	 */
+	bool Open(const std::string &name)
+	{
+		Close();
+
+		int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+		if (fd < 0)
+			return false;
+
+		struct stat st;
+		void *addr = MAP_FAILED;
+		if (::fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(Layout))
+			addr = ::mmap(NULL, sizeof(Layout), PROT_READ, MAP_SHARED, fd, 0);
+
+		::close(fd);
+		if (addr == MAP_FAILED)
+			return false;
+
+		_layout = static_cast<const Layout *>(addr);
+		_name = name;
+		_device = st.st_dev;
+		_inode = st.st_ino;
+		if (!isCurrent())
+		{
+			Close();
+			return false;
+		}
+
+		return true;
+	}
+
+	void Close()
+	{
+		if (_layout)
+			::munmap(const_cast<Layout *>(_layout), sizeof(Layout));
+
+		_layout = NULL;
+		_name.clear();
+	}
+
+	/**
+	 * @return True if the segment is mapped and the writer has not closed it
+	 */
+	bool isOpen() const
+	{
+		if (!_layout)
+			return false;
+
+		const Header &h = _layout->header;
+		return h.magic.load(std::memory_order_acquire) == Magic && h.version == Version &&
+				h.headerSize == sizeof(Header) && h.slotSize == sizeof(Slot) && h.maxSlots == MaxSlots;
+	}
+
+	/**
+	 * Check that the mapped segment still has a live writer.  A writer that
+	 * died without closing the segment, or was restarted and created a new
+	 * one, leaves this mapping open but never updated.  This makes system
+	 * calls, so should only be done every second or so.
+	 *
+	 * @return False if the segment should be opened again
+	 */
+	bool isCurrent() const
+	{
+		if (!isOpen())
+			return false;
+
+		pid_t pid = _layout->header.pid;
+		if (pid > 0 && ::kill(pid, 0) != 0 && errno == ESRCH)
+			return false;
+
+		int fd = ::shm_open(_name.c_str(), O_RDONLY, 0);
+		if (fd < 0)
+			return false;
+
+		struct stat st;
+		bool same = ::fstat(fd, &st) == 0 && st.st_dev == _device && st.st_ino == _inode;
+		::close(fd);
+		return same;
+	}
+
+	/**
+	 * @return The slot of the named value, or -1 if it is not defined
+	 */
+	int Find(const std::string &name) const
+	{
+		if (!isOpen())
+			return -1;
+
+		uint32_t count = _layout->header.count.load(std::memory_order_acquire);
+		for (uint32_t n = 0; n < count && n < MaxSlots; n++)
+		{
+			if (::strncmp(_layout->slots[n].name, name.c_str(), NameSize) == 0)
+				return n;
+		}
+
+		return -1;
+	}
+
+	/**
+	 * @return The unit of the slot, as used in the Vehicle Basic Message
+	 */
+	const char *Unit(int slot) const
+	{
+		return (isOpen() && slot >= 0 && (size_t)slot < MaxSlots) ? _layout->slots[slot].unit : "";
+	}
+
+	/**
+	 * Copy the current value of a slot
+	 *
+	 * @return False if the slot has no value, or no consistent copy could be
+	 * made, e.g. because the writer died in the middle of a write
+	 */
+	bool Read(int slot, Value &value) const
+	{
+		if (!isOpen() || slot < 0 || (size_t)slot >= MaxSlots)
+			return false;
+
+		const Slot &s = _layout->slots[slot];
+
+		uint32_t seq1, seq2;
+		unsigned attempts = 0;
+		do
+		{
+			if (attempts++ >= MaxReadAttempts)
+				return false;
+
+			seq1 = s.seq.load(std::memory_order_acquire);
+			value.type = static_cast<ValueType>(s.type.load(std::memory_order_relaxed));
+			value.i = s.i.load(std::memory_order_relaxed);
+			value.d = s.d.load(std::memory_order_relaxed);
+			value.time = s.time.load(std::memory_order_relaxed);
+			::memcpy(value.state, s.state, StateSize);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			seq2 = s.seq.load(std::memory_order_relaxed);
+		} while ((seq1 & 1) || seq1 != seq2);
+
+		value.state[StateSize - 1] = '\0';
+		return seq1 != 0 && value.type != ValueType::None;
+	}
+
+	/**
+	 * @return The number of value updates, which changes whenever any value does
+	 */
+	uint64_t get_Updates() const
+	{
+		return isOpen() ? _layout->header.updates.load(std::memory_order_relaxed) : 0;
+	}
+
+private:
+	const Layout *_layout = NULL;
+
+	// The segment that is mapped, to tell when the name refers to a new one
+	std::string _name;
+	dev_t _device = 0;
+	ino_t _inode = 0;
+};
+
+} /* End namespace SharedState */
+} /* End namespace VehicleInterfacePlugin */
+
+#endif /* SHAREDVEHICLESTATE_H_ */
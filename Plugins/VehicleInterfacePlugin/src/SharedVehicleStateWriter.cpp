@@ -0,0 +1,144 @@
+/*
+ * SharedVehicleStateWriter.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "SharedVehicleStateWriter.h"
+
+#include <cerrno>
+#include <PluginLog.h>
+
+using namespace std;
+using namespace tmx::utils;
+using namespace VehicleInterfacePlugin::SharedState;
+
+namespace VehicleInterfacePlugin {
+
+SharedVehicleStateWriter::~SharedVehicleStateWriter()
+{
+	Close();
+}
+
+bool SharedVehicleStateWriter::Open(const string &name)
+{
+	Close();
+
+	// A new segment, so readers of an old one are not confused by the reset
+	::shm_unlink(name.c_str());
+
+	int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+	if (fd < 0)
+	{
+		PLOG(logERROR) << "Unable to create shared memory " << name << ": " << strerror(errno);
+		return false;
+	}
+
+	void *addr = MAP_FAILED;
+	if (::ftruncate(fd, sizeof(Layout)) == 0)
+		addr = ::mmap(NULL, sizeof(Layout), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+	if (addr == MAP_FAILED)
+	{
+		PLOG(logERROR) << "Unable to map shared memory " << name << ": " << strerror(errno);
+		::close(fd);
+		::shm_unlink(name.c_str());
+		return false;
+	}
+
+	::close(fd);
+
+	// The new pages are already zero, so every slot is never written
+	Layout *layout = static_cast<Layout *>(addr);
+	_name = name;
+
+	Header &h = layout->header;
+	h.version = Version;
+	h.headerSize = sizeof(Header);
+	h.slotSize = sizeof(Slot);
+	h.maxSlots = MaxSlots;
+	h.pid = ::getpid();
+	h.count.store(0, memory_order_relaxed);
+	h.updates.store(0, memory_order_relaxed);
+	h.magic.store(Magic, memory_order_release);
+
+	_layout.store(layout, memory_order_release);
+
+	PLOG(logINFO) << "Exporting the vehicle state to shared memory " << name;
+	return true;
+}
+
+void SharedVehicleStateWriter::Close()
+{
+	Layout *layout = _layout.exchange(NULL, memory_order_acq_rel);
+	if (!layout)
+		return;
+
+	layout->header.magic.store(0, memory_order_release);
+
+	// Left mapped, for a worker that loaded the layout just before
+	::shm_unlink(_name.c_str());
+	_name.clear();
+}
+
+void SharedVehicleStateWriter::Define(int slot, const string &name, const string &unitSuffix)
+{
+	Layout *layout = _layout.load(memory_order_acquire);
+	if (!layout || slot < 0 || (size_t)slot >= MaxSlots)
+		return;
+
+	if (name.size() >= NameSize)
+		PLOG(logWARNING) << "Vehicle state name " << name << " is truncated in shared memory";
+
+	// The unit without the separator from the message string
+	size_t start = unitSuffix.find_first_not_of(' ');
+	string unit = (start == string::npos) ? "" : unitSuffix.substr(start);
+
+	Slot &s = layout->slots[slot];
+	strncpy(s.name, name.c_str(), NameSize - 1);
+	strncpy(s.unit, unit.c_str(), UnitSize - 1);
+
+	Header &h = layout->header;
+	if (h.count.load(memory_order_relaxed) <= (uint32_t)slot)
+		h.count.store(slot + 1, memory_order_release);
+}
+
+void SharedVehicleStateWriter::Publish(int slot, ValueType type, int64_t i, double d, const string *state, uint64_t time)
+{
+	Layout *layout = _layout.load(memory_order_acquire);
+	if (!layout || slot < 0 || (size_t)slot >= MaxSlots)
+		return;
+
+	Slot &s = layout->slots[slot];
+
+	uint32_t seq = s.seq.load(memory_order_relaxed);
+	s.seq.store(seq + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+
+	s.type.store(static_cast<uint8_t>(type), memory_order_relaxed);
+	s.i.store(i, memory_order_relaxed);
+	s.d.store(d, memory_order_relaxed);
+	s.time.store(time, memory_order_relaxed);
+	if (state)
+		strncpy(s.state, state->c_str(), StateSize - 1);
+	else
+		s.state[0] = '\0';
+
+	// Skip zero on wrap, which means never written
+	s.seq.store(seq + 2 ? seq + 2 : 2, memory_order_release);
+
+	layout->header.updates.fetch_add(1, memory_order_relaxed);
+}
+
+void SharedVehicleStateWriter::Clear(int slot)
+{
+	Layout *layout = _layout.load(memory_order_acquire);
+	if (!layout || slot < 0 || (size_t)slot >= MaxSlots)
+		return;
+
+	Slot &s = layout->slots[slot];
+	s.type.store(static_cast<uint8_t>(ValueType::None), memory_order_relaxed);
+	s.seq.store(0, memory_order_release);
+}
+
+} /* End namespace VehicleInterfacePlugin */
@@ -0,0 +1,75 @@
+/*
+ * SharedVehicleStateWriter.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef SHAREDVEHICLESTATEWRITER_H_
+#define SHAREDVEHICLESTATEWRITER_H_
+
+#include "SharedVehicleState.h"
+
+#include <atomic>
+#include <string>
+
+namespace VehicleInterfacePlugin {
+
+/**
+ * Owner of the shared memory segment for the vehicle state.
+ *
+ * The VehicleState calls the writer for every slot it defines and every value
+ * it stores, from within its own slot lock, so each shared slot only ever has
+ * one writer at a time.
+ *
+ * A segment stays mapped for the life of the process once it is created, as
+ * the CAN workers may still be storing values while the plugin shuts down.
+ */
+class SharedVehicleStateWriter {
+public:
+	SharedVehicleStateWriter() { }
+	~SharedVehicleStateWriter();
+
+	SharedVehicleStateWriter(const SharedVehicleStateWriter &) = delete;
+	SharedVehicleStateWriter &operator=(const SharedVehicleStateWriter &) = delete;
+
+	/**
+	 * Create the named segment, replacing any left from an earlier run
+	 *
+	 * @return False if the segment could not be created
+	 */
+	bool Open(const std::string &name);
+
+	/**
+	 * Mark the segment closed for the readers and remove it.  Any value stored
+	 * after this goes to the removed segment, which no reader can open.
+	 */
+	void Close();
+
+	bool isOpen() const { return _layout.load(std::memory_order_acquire) != NULL; }
+	const std::string &get_Name() const { return _name; }
+
+	/**
+	 * Set the name and unit of a slot.  A new slot must be defined before any
+	 * value is written, and in slot order.  A slot may be defined again to
+	 * change its unit.
+	 */
+	void Define(int slot, const std::string &name, const std::string &unitSuffix);
+
+	/**
+	 * Store a new value in the slot
+	 */
+	void Publish(int slot, SharedState::ValueType type, int64_t i, double d, const std::string *state, uint64_t time);
+
+	/**
+	 * Mark the slot as never written
+	 */
+	void Clear(int slot);
+
+private:
+	std::atomic<SharedState::Layout *> _layout { nullptr };
+	std::string _name;
+};
+
+} /* End namespace VehicleInterfacePlugin */
+
+#endif /* SHAREDVEHICLESTATEWRITER_H_ */
@@ -57,14 +57,13 @@ VehicleConnection *VehicleConnection::GetConnection() {
 
 void VehicleConnection::HandleVehicleData(const VehicleDataAdaptor &data)
 {
-	Stop();
-
 	{
 		std::lock_guard<mutex> lock(_dataLock);
 		_data.set_contents(data.get_container());
 		_dataUpdate = true;
 	}
 
+	// Only the workers whose requests changed are replaced
 	Start();
 }
 
@@ -94,58 +93,140 @@ void VehicleConnection::Start()
 	auto data = GetVehicleData();
 	auto drivers = data.get_drivers();
 
+	// The requests for each worker, by task and group key, or by the request itself
+	struct Plan {
+		TaskAllocator *allocator;
+		std::vector<message> requests;
+		std::string signature;
+	};
+
+	map<string, Plan> plans;
+
+	for (auto iter = drivers.begin(); iter != drivers.end(); iter++)
 	{
-		// Need a lock to start the threads
-		lock_guard<mutex> lock(_threadLock);
+		if (!iter->get_enabled())
+			continue;
+
+		std::string task = iter->get_name();
+		message_tree_type driverTree = iter->get_container().get_storage().get_tree();
+
+		// Make sure this task type allocator exists
+		if (!taskAllocators().count(task))
+			continue;
 
-		for (auto iter = drivers.begin(); iter != drivers.end(); iter++)
+		PLOG(logINFO) << "Initializing " << task << " " << iter->get_type() << " connection tasks.";
+
+		// Break apart each request into a new thread of this task type
+		for (auto request : data.get_array<message>(iter->get_type()))
 		{
-			if (!iter->get_enabled())
-				continue;
+			PLOG(logDEBUG2) << request;
+			message_tree_type reqTree = request.get_container().get_storage().get_tree();
+
+			// Merge the global task configuration data with the specific request configuration
+			// This is done so configuration parameters may be declared at a global level instead
+			// of repeated for each request.  This will assume that the specific request
+			// parameter overrides the global one.
+			bool changed = false;
+
+			// Loop through everything in the tree, looking for repeats
+			for (auto dIter = driverTree.begin(); dIter != driverTree.end(); dIter++)
+			{
+				if (reqTree.get(dIter->first, "__N/A__") == "__N/A__")
+				{
+					reqTree.put_child(dIter->first, dIter->second);
+					changed = true;
+				}
+			}
+
+			if (changed)
+				request.set_contents(reqTree);
 
-			std::string task = iter->get_name();
-			message_tree_type driverTree = iter->get_container().get_storage().get_tree();
+			TaskAllocator *allocator = taskAllocators()[task];
+			std::string contents = request.to_string();
 
-			// Make sure this task type allocator exists
-			if (!taskAllocators().count(task))
-				continue;
+			string key = allocator->GroupKey(request);
+			if (key.empty())
+				key = task + "#" + contents;
+			else
+				key = task + ":" + key;
+
+			Plan &plan = plans[key];
+			plan.allocator = allocator;
+			plan.requests.push_back(request);
+			plan.signature += contents;
+		}
+	}
 
-			PLOG(logINFO) << "Initializing " << task << " " << iter->get_type() << " connection tasks.";
+	vector<ThreadWorker *> started;
 
-			// Break apart each request into a new thread of this task type
-			for (auto request : data.get_array<message>(iter->get_type()))
+	{
+		// Need a lock to change the threads
+		lock_guard<mutex> lock(_threadLock);
+
+		map<string, RunningTask> next;
+
+		for (auto &p : plans)
+		{
+			auto running = _tasks.find(p.first);
+			if (running != _tasks.end())
 			{
-				PLOG(logDEBUG2) << request;
-				message_tree_type reqTree = request.get_container().get_storage().get_tree();
+				RunningTask task = running->second;
+				_tasks.erase(running);
 
-				// Merge the global task configuration data with the specific request configuration
-				// This is done so configuration parameters may be declared at a global level instead
-				// of repeated for each request.  This will assume that the specific request
-				// parameter overrides the global one.
-				bool changed = false;
+				if (task.signature == p.second.signature)
+				{
+					// Nothing changed, so leave it running
+					next[p.first] = task;
+					continue;
+				}
 
-				// Loop through everything in the tree, looking for repeats
-				for (auto dIter = driverTree.begin(); dIter != driverTree.end(); dIter++)
+				if (p.second.allocator->Reconfigure(task.worker, p.second.requests))
 				{
-					if (reqTree.get(dIter->first, "__N/A__") == "__N/A__")
-					{
-						reqTree.put_child(dIter->first, dIter->second);
-						changed = true;
-					}
+					PLOG(logDEBUG) << "Reconfigured " << p.first << " task";
+
+					task.signature = p.second.signature;
+					next[p.first] = task;
+					continue;
 				}
 
-				if (changed)
-					request.set_contents(reqTree);
+				// Replace the worker
+				_tasks[p.first] = task;
+			}
 
-				PLOG(logDEBUG) << "Starting new " << task << " " << iter->get_type() << " task for " << request;
+			PLOG(logDEBUG) << "Starting new " << p.first << " task for " << p.second.requests.size() << " requests";
 
-				int i = this->push_back(taskAllocators()[task]->Allocate(request));
+			RunningTask task;
+			task.signature = p.second.signature;
+			task.worker = p.second.allocator->Allocate(p.second.requests[0]);
+			for (size_t i = 1; i < p.second.requests.size(); i++)
+				p.second.allocator->AddRequest(task.worker, p.second.requests[i]);
 
-				auto *t = this->operator [](i);
-				if (t)
-					t->Start();
-			}
+			next[p.first] = task;
+			started.push_back(task.worker);
 		}
+
+		// The group only holds the current workers
+		this->Clear();
+		for (auto &t : next)
+			this->push_back(t.second.worker);
+
+		// Anything left is no longer configured, or has been replaced
+		PLOG(logDEBUG) << "Stopping " << _tasks.size() << " vehicle connection worker threads";
+
+		for (auto &t : _tasks)
+			delete t.second.worker;
+
+		_tasks.swap(next);
+
+		// Start the threads once every request has its worker
+		for (auto *t : started)
+			t->Start();
+	}
+
+	if (started.empty())
+	{
+		PLOG(logDEBUG) << "Kept all " << this->size() << " vehicle connection worker threads running.";
+		return;
 	}
 
 	// Wait a few to make sure all the threads have successfully started and none have died
@@ -162,7 +243,7 @@ void VehicleConnection::Start()
 		return;
 	}
 
-	PLOG(logDEBUG) << "Started " << this->size() << " vehicle connection worker threads.";
+	PLOG(logDEBUG) << "Started " << started.size() << " of " << this->size() << " vehicle connection worker threads.";
 }
 
 void VehicleConnection::Stop()
@@ -171,17 +252,12 @@ void VehicleConnection::Stop()
 
 	PLOG(logDEBUG) << "Stopping " << this->size() << " vehicle connection worker threads";
 
-	for (size_t i = 0; i < this->size(); i++)
-	{
-		auto *t = this->operator [](i);
-		if (t)
-		{
-			delete t;
-			t = NULL;
-		}
-	}
-
 	this->Clear();
+
+	for (auto &t : _tasks)
+		delete t.second.worker;
+
+	_tasks.clear();
 }
 
 bool VehicleConnection::IsRunning()
@@ -11,6 +11,7 @@
 #include "VehicleDataAdaptor.hpp"
 
 #include <map>
+#include <vector>
 #include <PluginLog.h>
 #include <ThreadGroup.h>
 #include <VehicleBasicMessage.h>
@@ -44,6 +45,24 @@ public:
 		virtual tmx::utils::ThreadWorker *Allocate(tmx::message config) = 0;
 		virtual std::string GetName() = 0;
 
+		/**
+		 * @return The key that groups requests into a single worker, or an
+		 * empty string to allocate a new worker for every request
+		 */
+		virtual std::string GroupKey(const tmx::message &config) { return ""; }
+
+		/**
+		 * Add a request to a worker allocated earlier for the same group key
+		 */
+		virtual void AddRequest(tmx::utils::ThreadWorker *worker, tmx::message config) { }
+
+		/**
+		 * Replace all the requests of a running worker
+		 *
+		 * @return False if the worker must be replaced instead
+		 */
+		virtual bool Reconfigure(tmx::utils::ThreadWorker *worker, const std::vector<tmx::message> &configs) { return false; }
+
 		void Register();
 	};
 
@@ -58,10 +77,46 @@ public:
 		std::string GetName() { return Task::TaskName; }
 	};
 
+	/**
+	 * Allocator for a task that handles all the requests with the same
+	 * Task::GroupKey in one worker, through Task::AddRequest
+	 */
+	template <class Task>
+	class GroupedTaskAllocatorImpl: public TaskAllocatorImpl<Task> {
+	public:
+		std::string GroupKey(const tmx::message &config) { return Task::GroupKey(config); }
+
+		void AddRequest(tmx::utils::ThreadWorker *worker, tmx::message config)
+		{
+			Task *task = dynamic_cast<Task *>(worker);
+			if (task)
+				task->AddRequest(config);
+		}
+
+		bool Reconfigure(tmx::utils::ThreadWorker *worker, const std::vector<tmx::message> &configs)
+		{
+			Task *task = dynamic_cast<Task *>(worker);
+			if (!task)
+				return false;
+
+			task->Reconfigure(configs);
+			return true;
+		}
+	};
+
 private:
 	VehicleConnection();
 
 	VehicleDataAdaptor _data;
+
+	// A worker and the requests it was built from
+	struct RunningTask {
+		std::string signature;
+		tmx::utils::ThreadWorker *worker;
+	};
+
+	// The running workers, by task and group key or request
+	std::map<std::string, RunningTask> _tasks;
 };
 
 } /* End namespace VehicleInterfacePlugin */
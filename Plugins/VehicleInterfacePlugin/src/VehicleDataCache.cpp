@@ -0,0 +1,255 @@
+/*
+ * VehicleDataCache.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "VehicleDataCache.h"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <PluginLog.h>
+
+#include <boost/filesystem.hpp>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define CACHE_MAGIC "VIDC"
+
+using namespace std;
+using namespace tmx;
+using namespace tmx::utils;
+
+namespace VehicleInterfacePlugin {
+
+struct CacheHeader {
+	char magic[4];
+	uint32_t version;
+	uint64_t key;
+	uint64_t size;
+	uint64_t checksum;
+};
+
+static uint64_t Fnv1a(const void *data, size_t len, uint64_t hash = 0xcbf29ce484222325ULL)
+{
+	const uint8_t *p = static_cast<const uint8_t *>(data);
+	for (size_t i = 0; i < len; i++)
+	{
+		hash ^= p[i];
+		hash *= 0x100000001b3ULL;
+	}
+
+	return hash;
+}
+
+uint64_t VehicleDataCache::Fingerprint(const vector<string> &files, const string &settings)
+{
+	uint64_t hash = Fnv1a(&Version, sizeof(Version));
+	hash = Fnv1a(settings.data(), settings.size(), hash);
+
+	// Only the file attributes, so the files do not have to be read
+	for (auto &file : files)
+	{
+		struct stat st;
+		if (::stat(file.c_str(), &st) != 0)
+			continue;
+
+		uint64_t size = st.st_size;
+		uint64_t mtime = (uint64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+
+		hash = Fnv1a(file.c_str(), file.length() + 1, hash);
+		hash = Fnv1a(&size, sizeof(size), hash);
+		hash = Fnv1a(&mtime, sizeof(mtime), hash);
+	}
+
+	return hash;
+}
+
+static void PutLength(string &out, size_t len)
+{
+	uint32_t n = len;
+	out.append(reinterpret_cast<const char *>(&n), sizeof(n));
+}
+
+static void PutString(string &out, const string &str)
+{
+	PutLength(out, str.length());
+	out.append(str);
+}
+
+/**
+ * Each node is its value, the number of children, then the key and node of each child
+ */
+static void Encode(string &out, const message_tree_type &tree)
+{
+	PutString(out, tree.data());
+	PutLength(out, tree.size());
+
+	for (auto &child : tree)
+	{
+		PutString(out, child.first);
+		Encode(out, child.second);
+	}
+}
+
+struct Decoder {
+	const char *p;
+	const char *end;
+
+	bool GetLength(size_t &len)
+	{
+		uint32_t n;
+		if (end - p < (ptrdiff_t)sizeof(n))
+			return false;
+
+		memcpy(&n, p, sizeof(n));
+		p += sizeof(n);
+		len = n;
+		return true;
+	}
+
+	bool GetString(string &str)
+	{
+		size_t len;
+		if (!GetLength(len) || (size_t)(end - p) < len)
+			return false;
+
+		str.assign(p, len);
+		p += len;
+		return true;
+	}
+
+	bool Decode(message_tree_type &tree, int depth = 0)
+	{
+		// Nothing in a vehicle file is nested this deep
+		if (depth > 64)
+			return false;
+
+		string value;
+		size_t count;
+		if (!GetString(value) || !GetLength(count))
+			return false;
+
+		tree.data() = value;
+
+		for (size_t i = 0; i < count; i++)
+		{
+			string key;
+			if (!GetString(key))
+				return false;
+
+			auto iter = tree.push_back(make_pair(key, message_tree_type()));
+			if (!Decode(iter->second, depth + 1))
+				return false;
+		}
+
+		return true;
+	}
+};
+
+bool VehicleDataCache::Load(uint64_t key, VehicleDataAdaptor &data)
+{
+	int fd = ::open(_file.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(CacheHeader))
+	{
+		::close(fd);
+		return false;
+	}
+
+	void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+
+	if (map == MAP_FAILED)
+		return false;
+
+	const char *bytes = static_cast<const char *>(map);
+
+	CacheHeader header;
+	memcpy(&header, bytes, sizeof(header));
+
+	bool ok = false;
+	if (memcmp(header.magic, CACHE_MAGIC, sizeof(header.magic)) != 0 || header.version != Version)
+	{
+		PLOG(logDEBUG) << _file << ": Not a version " << Version << " vehicle data cache";
+	}
+	else if (header.key != key)
+	{
+		PLOG(logDEBUG) << _file << ": Vehicle data cache is stale";
+	}
+	else if (header.size != st.st_size - sizeof(header) ||
+			Fnv1a(bytes + sizeof(header), header.size) != header.checksum)
+	{
+		PLOG(logWARNING) << _file << ": Vehicle data cache is corrupt";
+	}
+	else
+	{
+		Decoder decoder { bytes + sizeof(header), bytes + st.st_size };
+
+		message_tree_type tree;
+		ok = decoder.Decode(tree) && decoder.p == decoder.end;
+		if (ok)
+			data.set_contents(tree);
+	}
+
+	munmap(map, st.st_size);
+	return ok;
+}
+
+bool VehicleDataCache::Save(uint64_t key, VehicleDataAdaptor &data)
+{
+	string payload;
+	Encode(payload, data.get_container().get_storage().get_tree());
+
+	CacheHeader header;
+	memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+	header.version = Version;
+	header.key = key;
+	header.size = payload.size();
+	header.checksum = Fnv1a(payload.data(), payload.size());
+
+	try
+	{
+		boost::filesystem::path dir = boost::filesystem::path(_file).parent_path();
+		if (!dir.empty())
+			boost::filesystem::create_directories(dir);
+	}
+	catch (exception &ex)
+	{
+		PLOG(logWARNING) << "Unable to create the directory for " << _file << ": " << ex.what();
+		return false;
+	}
+
+	// Write a new file and move it into place, so a reader never sees part of one
+	string tmp = _file + ".tmp";
+	FILE *out = fopen(tmp.c_str(), "wb");
+	if (!out)
+	{
+		PLOG(logWARNING) << "Unable to write " << tmp << ": " << strerror(errno);
+		return false;
+	}
+
+	bool ok = fwrite(&header, sizeof(header), 1, out) == 1 &&
+			fwrite(payload.data(), 1, payload.size(), out) == payload.size();
+	ok = (fclose(out) == 0) && ok;
+
+	if (!ok || ::rename(tmp.c_str(), _file.c_str()) != 0)
+	{
+		PLOG(logWARNING) << "Unable to save the vehicle data cache " << _file << ": " << strerror(errno);
+		::unlink(tmp.c_str());
+		return false;
+	}
+
+	PLOG(logDEBUG) << "Saved " << payload.size() << " bytes of vehicle data to " << _file;
+	return true;
+}
+
+} /* End namespace VehicleInterfacePlugin */
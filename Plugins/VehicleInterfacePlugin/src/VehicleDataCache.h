@@ -0,0 +1,60 @@
+/*
+ * VehicleDataCache.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef VEHICLEDATACACHE_H_
+#define VEHICLEDATACACHE_H_
+
+#include "VehicleDataAdaptor.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace VehicleInterfacePlugin {
+
+/**
+ * Binary cache of the merged vehicle data, so the configuration files do
+ * not have to be parsed again on every start.
+ *
+ * The cache is keyed by a fingerprint of the name, size and modification
+ * time of every candidate file, plus the other settings that select the
+ * data, such as the Make, Model and Year.  Any change to those makes the
+ * cache stale, and it is rebuilt from the files.
+ *
+ * The file is a versioned header followed by the data tree in a compact
+ * length-prefixed form.  It is mapped into memory to be read, and replaced
+ * atomically when written.
+ */
+class VehicleDataCache {
+public:
+	static constexpr uint32_t Version = 1;
+
+	VehicleDataCache(const std::string &file): _file(file) { }
+
+	/**
+	 * @return The key for the files and the other settings
+	 */
+	static uint64_t Fingerprint(const std::vector<std::string> &files, const std::string &settings);
+
+	/**
+	 * Read the vehicle data from the cache
+	 *
+	 * @return False if there is no cache, it is corrupt, or it has a different key
+	 */
+	bool Load(uint64_t key, VehicleDataAdaptor &data);
+
+	/**
+	 * Replace the cache with the vehicle data
+	 */
+	bool Save(uint64_t key, VehicleDataAdaptor &data);
+
+private:
+	std::string _file;
+};
+
+} /* End namespace VehicleInterfacePlugin */
+
+#endif /* VEHICLEDATACACHE_H_ */
@@ -7,12 +7,20 @@
 //				 SocketCAN and sends out a Vehicle Message
 //============================================================================
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <map>
 #include <mutex>
 
 #include "PluginClient.h"
+#include "ChangeMonitor.h"
+#include "SharedVehicleStateWriter.h"
+#include "VehicleDataCache.h"
 #include "VehicleFileAdaptor.hpp"
 #include "VehicleConnection.h"
+#include "VehicleState.h"
+#include "workers/CanBusStatistics.hpp"
 
 #include <boost/filesystem.hpp>
 #include <VehicleBasicMessage.h>
@@ -51,10 +59,28 @@ protected:
 private:
 	std::atomic<uint64_t> _frequency { 0 };
 
+	// Send on a change of a critical value instead of at a fixed frequency
+	std::atomic<bool> _onChange { false };
+	std::atomic<uint64_t> _minInterval { 20 };
+	std::atomic<uint64_t> _maxInterval { 300 };
+	std::atomic<bool> _signalsChanged { false };
+	std::string _criticalSignals;
+
+	// Values received from other sources.  The CAN workers write to the VehicleState.
 	std::mutex _lock;
 	VehicleBasicMessage _msg;
 
+	// The status values last published, only used by the main thread
+	std::map<std::string, std::string> _status;
+	std::atomic<bool> _statusReset { false };
+
+	// Optional copy of the vehicle state for other plugins on this host
+	SharedVehicleStateWriter _shared;
+	std::string _sharedName;
+
 	void SendVehicleMessage();
+	tmx::message_tree_type BuildTree(tmx::message_tree_type *times = NULL);
+	void PublishStatus(const tmx::message_tree_type &tree);
 };
 
 static VehicleInterfacePlugin *_vehicleInterface = NULL;
@@ -75,7 +101,12 @@ VehicleInterfacePlugin::VehicleInterfacePlugin(std::string name):
 /**
  * Default Deconstructor
  */
-VehicleInterfacePlugin::~VehicleInterfacePlugin() { }
+VehicleInterfacePlugin::~VehicleInterfacePlugin()
+{
+	// No worker may still be storing values once the export goes
+	VehicleConnection::GetConnection()->Stop();
+	VehicleState::GetState().Export(NULL);
+}
 
 /**
  * Function updates all of the configureation params
@@ -83,6 +114,24 @@ VehicleInterfacePlugin::~VehicleInterfacePlugin() { }
 void VehicleInterfacePlugin::UpdateConfigSettings()
 {
 	GetConfigValue("Frequency", _frequency);
+	GetConfigValue("MinInterval", _minInterval);
+	GetConfigValue("MaxInterval", _maxInterval);
+
+	string mode;
+	if (GetConfigValue("BroadcastMode", mode))
+		_onChange = (strcasecmp(mode.c_str(), "Change") == 0);
+
+	string timed;
+	if (GetConfigValue("TimedSignals", timed))
+		VehicleState::GetState().set_TimedSignals(timed);
+
+	string signals;
+	if (GetConfigValue("CriticalSignals", signals))
+	{
+		lock_guard<mutex> lock(_lock);
+		_criticalSignals = signals;
+		_signalsChanged = true;
+	}
 
 	VehicleDataAdaptor data;
 
@@ -97,10 +146,24 @@ void VehicleInterfacePlugin::UpdateConfigSettings()
 	std::string drivers;
 	std::string inputs;
 	std::string cfgDir;
+	std::string cacheFile;
 
 	GetConfigValue("Drivers", drivers);
 	GetConfigValue("Inputs", inputs);
 	GetConfigValue("ConfigDir", cfgDir);
+	GetConfigValue("CacheFile", cacheFile);
+
+	// The workers may be writing to the segment, so it is only opened once
+	string sharedMemory;
+	if (GetConfigValue("SharedMemory", sharedMemory) && sharedMemory != _sharedName)
+	{
+		_sharedName = sharedMemory;
+
+		if (_shared.isOpen())
+			PLOG(logWARNING) << "Restart the plugin to change the shared memory from " << _shared.get_Name();
+		else if (!sharedMemory.empty() && _shared.Open(sharedMemory))
+			VehicleState::GetState().Export(&_shared);
+	}
 
 	// Create a map of selected files
 	map<string, bool> enabledFile;
@@ -124,6 +187,8 @@ void VehicleInterfacePlugin::UpdateConfigSettings()
 	// Iterator over all the input JSON config files to come up with a single vehicle data file
 	try
 	{
+		vector<string> files;
+
 		boost::filesystem::path dir(cfgDir);
 		for (boost::filesystem::directory_iterator itr(dir); itr != boost::filesystem::directory_iterator(); itr++)
 		{
@@ -131,19 +196,41 @@ void VehicleInterfacePlugin::UpdateConfigSettings()
 			if (jsonFile.extension() != ".json" && jsonFile.extension() != ".vinfo")
 				continue;
 
-			PLOG(logDEBUG) << "Found vehicle file: " << jsonFile << endl;
+			files.push_back(jsonFile.string());
+		}
 
-			message_container_type c;
-			c.load<JSON>(jsonFile.string());
+		sort(files.begin(), files.end());
 
-			VehicleFileAdaptor veh;
-			veh.set_contents(c);
+		// The merged data only depends on the files and these settings
+		VehicleDataCache cache(cacheFile);
+		uint64_t key = VehicleDataCache::Fingerprint(files,
+				data.get_make() + "\n" + data.get_model() + "\n" + data.get_year() + "\n" + drivers + "\n" + inputs);
 
-			if (!enabledFile.count(veh.get_name()) || !enabledFile[veh.get_name()])
-				continue;
+		if (!cacheFile.empty() && cache.Load(key, data))
+		{
+			PLOG(logINFO) << "Loaded vehicle data from " << cacheFile;
+		}
+		else
+		{
+			for (auto &jsonFile : files)
+			{
+				PLOG(logDEBUG) << "Found vehicle file: " << jsonFile << endl;
+
+				message_container_type c;
+				c.load<JSON>(jsonFile);
 
-			PLOG(logDEBUG1) << "Including vehicle file: " << veh << endl;
-			data.add_file(veh);
+				VehicleFileAdaptor veh;
+				veh.set_contents(c);
+
+				if (!enabledFile.count(veh.get_name()) || !enabledFile[veh.get_name()])
+					continue;
+
+				PLOG(logDEBUG1) << "Including vehicle file: " << veh << endl;
+				data.add_file(veh);
+			}
+
+			if (!cacheFile.empty())
+				cache.Save(key, data);
 		}
 
 		PLOG(logDEBUG) << "Complete data file: " << data;
@@ -181,7 +268,11 @@ void VehicleInterfacePlugin::OnStateChange(IvpPluginState state)
 {
 	PluginClient::OnStateChange(state);
 	if (state == IvpPluginState_registered)
+	{
+		// Publish every status value again
+		_statusReset = true;
 		UpdateConfigSettings();
+	}
 }
 
 void VehicleInterfacePlugin::HandleVehicleBasicMessage(VehicleBasicMessage &vehMsg, routeable_message &rMsg) {
@@ -205,6 +296,64 @@ void VehicleInterfacePlugin::HandleVehicleBasicMessage(VehicleBasicMessage &vehM
 	_msg.set_contents(tree);
 }
 
+/**
+ * Build the message contents, from the other sources and the vehicle state,
+ * with the measurement times in a separate tree if given
+ */
+message_tree_type VehicleInterfacePlugin::BuildTree(message_tree_type *times)
+{
+	message_tree_type tree;
+	{
+		lock_guard<mutex> lock(_lock);
+		tree = _msg.get_container().get_storage().get_tree();
+	}
+
+	// Only convert the decoded values to strings when they are sent
+	if (times)
+		VehicleState::GetState().Serialize(tree, *times);
+	else
+		VehicleState::GetState().Serialize(tree);
+
+	return tree;
+}
+
+/**
+ * Update the status of only the values that changed since they were last published.
+ * The measurement times change with every frame, so they are not published.
+ */
+void VehicleInterfacePlugin::PublishStatus(const message_tree_type &tree)
+{
+	if (_statusReset.exchange(false))
+		_status.clear();
+
+	vector<pair<const string *, const string *> > changed;
+
+	for (auto iter = tree.begin(); iter != tree.end(); iter++)
+	{
+		const string &key = iter->first;
+		if (key.length() > 4 && key.compare(key.length() - 4, 4, "Time") == 0 &&
+				tree.find(key.substr(0, key.length() - 4)) != tree.not_found())
+			continue;
+
+		auto last = _status.find(key);
+		if (last != _status.end() && last->second == iter->second.data())
+			continue;
+
+		string &value = _status[key];
+		value = iter->second.data();
+		changed.push_back(make_pair(&key, &value));
+	}
+
+	if (changed.empty())
+		return;
+
+	PLOG(logDEBUG1) << "Publishing " << changed.size() << " changed status values";
+
+	// All the changes go out together
+	for (auto &status : changed)
+		SetStatus(status.first->c_str(), status.second->empty() ? "Unknown" : status.second->c_str());
+}
+
 int VehicleInterfacePlugin::Main()
 {
 	PLOG(logINFO) << "Starting Plugin.";
@@ -217,6 +366,12 @@ int VehicleInterfacePlugin::Main()
 
 	int freq = 0;
 
+	ChangeMonitor monitor;
+	message_tree_type lastValues;
+	chrono::steady_clock::time_point lastSent;
+	chrono::steady_clock::time_point lastChecked;
+	int64_t wait = 0;
+
 	while(_plugin->state != IvpPluginState_error)
 	{
 		if (freq != _frequency) {
@@ -224,26 +379,79 @@ int VehicleInterfacePlugin::Main()
 			throttle.set_Frequency(chrono::milliseconds(freq));
 		}
 
-		// Send the message only when it is time
-		if (throttle.Monitor(0)) {
-			{
-				lock_guard<mutex> lock(_lock);
-				vehMsg = _msg;
+		if (_signalsChanged.exchange(false)) {
+			lock_guard<mutex> lock(_lock);
+			monitor.Configure(_criticalSignals);
+		}
+
+		if (_onChange) {
+			// Send right away on a critical change, but no more often than the minimum interval,
+			// and otherwise at the frequency only if something changed
+			auto now = chrono::steady_clock::now();
+			auto sinceSent = chrono::duration_cast<chrono::milliseconds>(now - lastSent).count();
+			auto sinceChecked = chrono::duration_cast<chrono::milliseconds>(now - lastChecked).count();
+
+			bool changed = monitor.Changed();
+			bool send = (changed && sinceSent >= (int64_t)_minInterval);
+
+			// A steady value is still sent at the maximum interval, so it is not taken for a lost message
+			if (!send && _maxInterval > 0 && sinceSent >= (int64_t)_maxInterval)
+				send = true;
+
+			if (send || sinceChecked >= freq) {
+				lastChecked = now;
+
+				// The measurement times change with every frame, so compare without them
+				message_tree_type times;
+				message_tree_type values = BuildTree(&times);
+				if (!send)
+					send = (values != lastValues);
+
+				if (send) {
+					lastValues = values;
+					for (auto &time : times)
+						values.put(time.first, time.second.data());
+
+					vehMsg.set_contents(values);
+					if (!vehMsg.is_empty())
+						this->BroadcastMessage(vehMsg);
+
+					monitor.Sent();
+					lastSent = now;
+					sinceSent = 0;
+					changed = false;
+				}
+
+				sinceChecked = 0;
 			}
 
+			// Until the next check, the heartbeat, or the end of the minimum interval for a held change
+			wait = freq - sinceChecked;
+			if (_maxInterval > 0)
+				wait = min<int64_t>(wait, (int64_t)_maxInterval - sinceSent);
+			if (changed)
+				wait = min<int64_t>(wait, (int64_t)_minInterval - sinceSent);
+		}
+		// Send the message only when it is time
+		else if (throttle.Monitor(0)) {
+			vehMsg.set_contents(BuildTree());
+
 			if (!vehMsg.is_empty())
 				this->BroadcastMessage(vehMsg);
 		}
 
 		if (statusThrottle.Monitor(0)) {
-			message_tree_type keys = vehMsg.get_container().get_storage().get_tree();
-			keys.sort();
-			for (auto iter = keys.begin(); iter != keys.end(); iter++)
-				SetStatus(iter->first.c_str(),
-					keys.get<string>(iter->first, "Unknown").c_str());
+			PublishStatus(vehMsg.get_container().get_storage().get_tree());
+
+			for (auto &stats : Can::CanBusStatistics::All())
+				SetStatus(("CAN " + stats->bus).c_str(), stats->Summary().c_str());
 		}
 
-		this_thread::sleep_for(chrono::milliseconds(freq / 5));
+		// In Change mode, a store to a critical signal ends the wait early
+		if (_onChange)
+			VehicleState::GetState().WaitForChange(chrono::milliseconds(max<int64_t>(1, wait)));
+		else
+			this_thread::sleep_for(chrono::milliseconds(freq / 5));
 	}
 
 	return 0;
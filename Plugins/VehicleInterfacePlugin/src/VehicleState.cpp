@@ -0,0 +1,456 @@
+/*
+ * VehicleState.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "VehicleState.h"
+#include "SharedVehicleStateWriter.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <PluginLog.h>
+#include <poll.h>
+#include <sstream>
+#include <sys/eventfd.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace std;
+using namespace tmx;
+using namespace tmx::utils;
+
+namespace VehicleInterfacePlugin {
+
+VehicleState::VehicleState(): _timed { "Speed" }
+{
+	_changeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+}
+
+VehicleState &VehicleState::GetState()
+{
+	static VehicleState _state;
+	return _state;
+}
+
+int VehicleState::Register(const string &name, const string &unitSuffix)
+{
+	lock_guard<mutex> lock(_lock);
+
+	size_t count = _count;
+	for (size_t i = 0; i < count; i++)
+	{
+		if (_slots[i].name == name)
+		{
+			// A reloaded definition may change the unit
+			Slot &slot = _slots[i];
+			if (slot.refs++ == 0 || slot.unitSuffix != unitSuffix)
+			{
+				slot.unitSuffix = unitSuffix;
+
+				SharedVehicleStateWriter *shared = _shared.load(memory_order_acquire);
+				if (shared)
+					shared->Define(i, name, unitSuffix);
+			}
+
+			return i;
+		}
+	}
+
+	if (count >= MaxSlots)
+	{
+		PLOG(logERROR) << "No vehicle state slot left for " << name;
+		return -1;
+	}
+
+	Slot &slot = _slots[count];
+	slot.name = name;
+	slot.unitSuffix = unitSuffix;
+	slot.seq = 0;
+	slot.type = 0;
+	slot.refs = 1;
+	slot.timed = _timed.count(name) > 0;
+
+	SharedVehicleStateWriter *shared = _shared.load(memory_order_acquire);
+	if (shared)
+		shared->Define(count, name, unitSuffix);
+
+	_count = count + 1;
+	return count;
+}
+
+const string *VehicleState::Intern(const string &state)
+{
+	lock_guard<mutex> lock(_lock);
+
+	for (auto &s: _interned)
+	{
+		if (s == state)
+			return &s;
+	}
+
+	_interned.push_back(state);
+	return &_interned.back();
+}
+
+void VehicleState::set_TimedSignals(const string &names)
+{
+	set<string> timed;
+
+	istringstream in(names);
+	string name;
+	while (getline(in, name, ','))
+	{
+		// Trim the white space around the name
+		size_t first = name.find_first_not_of(" \t");
+		size_t last = name.find_last_not_of(" \t");
+		if (first != string::npos)
+			timed.insert(name.substr(first, last - first + 1));
+	}
+
+	lock_guard<mutex> lock(_lock);
+
+	_timed.swap(timed);
+	for (size_t n = 0; n < _count; n++)
+		_slots[n].timed = _timed.count(_slots[n].name) > 0;
+}
+
+void VehicleState::Retain(int slot)
+{
+	if (slot < 0 || (size_t)slot >= _count)
+		return;
+
+	lock_guard<mutex> lock(_lock);
+	_slots[slot].refs++;
+}
+
+void VehicleState::Release(int slot)
+{
+	if (slot < 0 || (size_t)slot >= _count)
+		return;
+
+	lock_guard<mutex> lock(_lock);
+
+	Slot &s = _slots[slot];
+	if (s.refs > 0 && --s.refs == 0)
+	{
+		// No decoder writes the slot any more, so mark it as never written
+		s.seq.store(0, memory_order_release);
+		s.time = 0;
+
+		SharedVehicleStateWriter *shared = _shared.load(memory_order_acquire);
+		if (shared)
+			shared->Clear(slot);
+	}
+}
+
+uint32_t VehicleState::BeginWrite(Slot &slot)
+{
+	// Wait out any other writer of the same slot, then mark the slot as being written
+	uint32_t seq = slot.seq.load(memory_order_relaxed);
+	do
+	{
+		while (seq & 1)
+			seq = slot.seq.load(memory_order_relaxed);
+	} while (!slot.seq.compare_exchange_weak(seq, seq + 1, memory_order_acquire, memory_order_relaxed));
+
+	return seq + 1;
+}
+
+void VehicleState::EndWrite(Slot &slot, uint32_t seq, uint64_t time)
+{
+	if (!time)
+		time = Now();
+
+	slot.time.store(time, memory_order_relaxed);
+
+	// Still within the write, so the shared slot has this writer only
+	SharedVehicleStateWriter *shared = _shared.load(memory_order_acquire);
+	if (shared)
+	{
+		shared->Publish(&slot - _slots, static_cast<SharedState::ValueType>(slot.type.load(memory_order_relaxed)),
+				slot.i.load(memory_order_relaxed), slot.d.load(memory_order_relaxed),
+				slot.state.load(memory_order_relaxed), time);
+	}
+
+	slot.seq.store(seq + 1, memory_order_release);
+	_updates.fetch_add(1, memory_order_relaxed);
+
+	if (slot.watched.load(memory_order_relaxed))
+	{
+		_changed.store(true, memory_order_relaxed);
+
+		// Pairs with the fence in WaitForChange, so either the waiter sees the change or it is woken
+		atomic_thread_fence(memory_order_seq_cst);
+
+		if (_waiting.load(memory_order_relaxed) && _waiting.exchange(false) && _changeFd >= 0)
+		{
+			uint64_t one = 1;
+			if (::write(_changeFd, &one, sizeof(one)) < 0)
+				PLOG(logDEBUG) << "Unable to wake the vehicle state waiter: " << strerror(errno);
+		}
+	}
+}
+
+void VehicleState::Watch(int slot, bool watch)
+{
+	if (slot < 0 || (size_t)slot >= MaxSlots)
+		return;
+
+	_slots[slot].watched.store(watch, memory_order_relaxed);
+}
+
+bool VehicleState::WaitForChange(chrono::milliseconds timeout)
+{
+	_waiting = true;
+	atomic_thread_fence(memory_order_seq_cst);
+
+	if (!_changed.load(memory_order_relaxed) && _changeFd >= 0)
+	{
+		struct pollfd pfd;
+		pfd.fd = _changeFd;
+		pfd.events = POLLIN;
+		::poll(&pfd, 1, timeout.count());
+
+		uint64_t count;
+		if (::read(_changeFd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+			PLOG(logDEBUG) << "Unable to clear the vehicle state wake up: " << strerror(errno);
+	}
+	else if (_changeFd < 0)
+	{
+		this_thread::sleep_for(timeout);
+	}
+
+	_waiting = false;
+
+	// Any number of stores since the last wait are one change
+	return _changed.exchange(false);
+}
+
+void VehicleState::Export(SharedVehicleStateWriter *writer)
+{
+	lock_guard<mutex> lock(_lock);
+
+	if (!writer)
+	{
+		_shared.store(writer, memory_order_release);
+		return;
+	}
+
+	for (size_t n = 0; n < _count; n++)
+		writer->Define(n, _slots[n].name, _slots[n].unitSuffix);
+
+	_shared.store(writer, memory_order_release);
+
+	// Copy the current values under the slot locks, so a newer value written
+	// by a worker in the meantime is not overwritten
+	for (size_t n = 0; n < _count; n++)
+	{
+		Slot &s = _slots[n];
+		if (s.refs == 0 || s.seq.load(memory_order_acquire) == 0)
+			continue;
+
+		uint32_t seq = BeginWrite(s);
+		writer->Publish(n, static_cast<SharedState::ValueType>(s.type.load(memory_order_relaxed)),
+				s.i.load(memory_order_relaxed), s.d.load(memory_order_relaxed),
+				s.state.load(memory_order_relaxed), s.time.load(memory_order_relaxed));
+		s.seq.store(seq + 1, memory_order_release);
+	}
+}
+
+uint64_t VehicleState::Now()
+{
+	return chrono::duration_cast<chrono::microseconds>(chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void VehicleState::SetInt(int slot, int64_t value, uint64_t time)
+{
+	if (slot < 0 || (size_t)slot >= MaxSlots)
+		return;
+
+	Slot &s = _slots[slot];
+	uint32_t seq = BeginWrite(s);
+	s.type.store(static_cast<uint8_t>(SlotType::Int), memory_order_relaxed);
+	s.i.store(value, memory_order_relaxed);
+	EndWrite(s, seq, time);
+}
+
+void VehicleState::SetDouble(int slot, double value, uint64_t time)
+{
+	if (slot < 0 || (size_t)slot >= MaxSlots)
+		return;
+
+	Slot &s = _slots[slot];
+	uint32_t seq = BeginWrite(s);
+	s.type.store(static_cast<uint8_t>(SlotType::Double), memory_order_relaxed);
+	s.d.store(value, memory_order_relaxed);
+	EndWrite(s, seq, time);
+}
+
+void VehicleState::SetState(int slot, const string *state, uint64_t time)
+{
+	if (slot < 0 || (size_t)slot >= MaxSlots || !state)
+		return;
+
+	Slot &s = _slots[slot];
+	uint32_t seq = BeginWrite(s);
+	s.type.store(static_cast<uint8_t>(SlotType::State), memory_order_relaxed);
+	s.state.store(state, memory_order_relaxed);
+	EndWrite(s, seq, time);
+}
+
+int VehicleState::Find(const string &name)
+{
+	lock_guard<mutex> lock(_lock);
+
+	for (size_t i = 0; i < _count; i++)
+	{
+		if (_slots[i].name == name)
+			return i;
+	}
+
+	return -1;
+}
+
+bool VehicleState::Get(int slot, double &number, const string *&state)
+{
+	if (slot < 0 || (size_t)slot >= MaxSlots)
+		return false;
+
+	Slot &s = _slots[slot];
+
+	uint32_t seq1, seq2;
+	SlotType type;
+	int64_t i;
+	double d;
+	const string *st;
+
+	do
+	{
+		seq1 = s.seq.load(memory_order_acquire);
+		type = static_cast<SlotType>(s.type.load(memory_order_relaxed));
+		i = s.i.load(memory_order_relaxed);
+		d = s.d.load(memory_order_relaxed);
+		st = s.state.load(memory_order_relaxed);
+		atomic_thread_fence(memory_order_acquire);
+		seq2 = s.seq.load(memory_order_relaxed);
+	} while ((seq1 & 1) || seq1 != seq2);
+
+	if (seq1 == 0)
+		return false;
+
+	switch (type)
+	{
+	case SlotType::Int:
+		number = i;
+		state = NULL;
+		return true;
+	case SlotType::Double:
+		number = d;
+		state = NULL;
+		return true;
+	case SlotType::State:
+		number = 0;
+		state = st;
+		return true;
+	default:
+		return false;
+	}
+}
+
+uint64_t VehicleState::get_Time(int slot)
+{
+	if (slot < 0 || (size_t)slot >= MaxSlots)
+		return 0;
+
+	Slot &s = _slots[slot];
+
+	uint32_t seq1, seq2;
+	uint64_t time;
+	do
+	{
+		seq1 = s.seq.load(memory_order_acquire);
+		time = s.time.load(memory_order_relaxed);
+		atomic_thread_fence(memory_order_acquire);
+		seq2 = s.seq.load(memory_order_relaxed);
+	} while ((seq1 & 1) || seq1 != seq2);
+
+	return time;
+}
+
+size_t VehicleState::Serialize(message_tree_type &tree, bool times)
+{
+	return SerializeSlots(tree, times ? &tree : NULL);
+}
+
+size_t VehicleState::Serialize(message_tree_type &values, message_tree_type &times)
+{
+	return SerializeSlots(values, &times);
+}
+
+size_t VehicleState::SerializeSlots(message_tree_type &tree, message_tree_type *times)
+{
+	lock_guard<mutex> lock(_lock);
+
+	size_t added = 0;
+	for (size_t n = 0; n < _count; n++)
+	{
+		Slot &s = _slots[n];
+
+		uint32_t seq1, seq2;
+		SlotType type;
+		uint64_t time;
+		int64_t i;
+		double d;
+		const string *state;
+
+		do
+		{
+			seq1 = s.seq.load(memory_order_acquire);
+			type = static_cast<SlotType>(s.type.load(memory_order_relaxed));
+			i = s.i.load(memory_order_relaxed);
+			d = s.d.load(memory_order_relaxed);
+			state = s.state.load(memory_order_relaxed);
+			time = s.time.load(memory_order_relaxed);
+			atomic_thread_fence(memory_order_acquire);
+			seq2 = s.seq.load(memory_order_relaxed);
+		} while ((seq1 & 1) || seq1 != seq2);
+
+		// Never written
+		if (seq1 == 0)
+			continue;
+
+		char buf[32];
+		switch (type)
+		{
+		case SlotType::Int:
+			snprintf(buf, sizeof(buf), "%lld", (long long)i);
+			tree.put(s.name, buf + s.unitSuffix);
+			break;
+		case SlotType::Double:
+			// Same as the default stream format
+			snprintf(buf, sizeof(buf), "%g", d);
+			tree.put(s.name, buf + s.unitSuffix);
+			break;
+		case SlotType::State:
+			tree.put(s.name, *state + s.unitSuffix);
+			break;
+		default:
+			continue;
+		}
+
+		if (times && s.timed)
+		{
+			snprintf(buf, sizeof(buf), "%llu", (unsigned long long)(time / 1000));
+			times->put(s.name + "Time", buf);
+		}
+
+		added++;
+	}
+
+	return added;
+}
+
+} /* End namespace VehicleInterfacePlugin */
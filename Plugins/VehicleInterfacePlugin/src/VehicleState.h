@@ -0,0 +1,213 @@
+/*
+ * VehicleState.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef VEHICLESTATE_H_
+#define VEHICLESTATE_H_
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <string>
+
+#include <tmx/messages/message.hpp>
+
+namespace VehicleInterfacePlugin {
+
+class SharedVehicleStateWriter;
+
+/**
+ * Typed, in-memory copy of the latest vehicle data.
+ *
+ * Each named value, such as Speed or GearPosition, has a fixed slot that is
+ * assigned when the worker configurations are compiled.  The workers update
+ * the slots without taking a lock or allocating, and the values are only
+ * converted to strings when the plugin builds the Vehicle Basic Message.
+ *
+ * Slots are reference counted by the decoders bound to them, so a value
+ * disappears from the message once no running definition produces it, and
+ * the definitions can be reloaded without clearing the values that remain.
+ *
+ * Every slot is guarded by its own sequence lock, so a reader always sees a
+ * consistent value even while several workers write the same slot.  Each
+ * value also keeps the time it was measured, which is the receive time of
+ * the frame it was decoded from when the interface can provide one.
+ *
+ * The state may also be exported to shared memory, in which case every value
+ * is copied to the segment as it is stored.
+ *
+ * Slots may be watched, so that a thread waiting for a change is woken as soon
+ * as any watched value is stored.
+ */
+class VehicleState {
+public:
+	static constexpr size_t MaxSlots = 256;
+
+	enum class SlotType: uint8_t {
+		None = 0,
+		Int,
+		Double,
+		State
+	};
+
+	static VehicleState &GetState();
+
+	/**
+	 * Find or assign the slot for the named value, and add a reference to it.
+	 * A new slot is not visible to the workers until its number is returned,
+	 * so this is safe to call while other slots are being updated.
+	 *
+	 * @param name The name of the value in the Vehicle Basic Message
+	 * @param unitSuffix The unit with its separator, appended to the value
+	 * @return The slot number, or -1 if all the slots are used
+	 */
+	int Register(const std::string &name, const std::string &unitSuffix);
+
+	/**
+	 * @return A permanent copy of the enumeration state name, for use with SetState
+	 */
+	const std::string *Intern(const std::string &state);
+
+	/**
+	 * @return The current time in microseconds since the epoch, in the same
+	 * form as the measurement times
+	 */
+	static uint64_t Now();
+
+	void SetInt(int slot, int64_t value, uint64_t time);
+	void SetDouble(int slot, double value, uint64_t time);
+	void SetState(int slot, const std::string *state, uint64_t time);
+
+	/**
+	 * @return The slot of the named value, or -1 if it is not registered
+	 */
+	int Find(const std::string &name);
+
+	/**
+	 * Read the current value of a slot.  A number is returned for an integer
+	 * or a double, and the interned name for an enumeration state.
+	 *
+	 * @return False if the slot has no value
+	 */
+	bool Get(int slot, double &number, const std::string *&state);
+
+	/**
+	 * @return The measurement time of the slot in microseconds since the
+	 * epoch, or zero if never written
+	 */
+	uint64_t get_Time(int slot);
+
+	/**
+	 * Wake up WaitForChange() whenever a value is stored in the slot, or stop
+	 */
+	void Watch(int slot, bool watch);
+
+	/**
+	 * Block until a watched value is stored, or the timeout
+	 *
+	 * @return True if a watched value was stored
+	 */
+	bool WaitForChange(std::chrono::milliseconds timeout);
+
+	/**
+	 * Add another reference to a registered slot, e.g. for a copy of a decoder
+	 */
+	void Retain(int slot);
+
+	/**
+	 * Drop a reference to the slot.  The value is no longer sent once the last
+	 * reference is dropped, but the slot keeps its name so it can be reused.
+	 */
+	void Release(int slot);
+
+	/**
+	 * Set the values whose measurement times are sent, from a comma-separated
+	 * list of names.  Only Speed is timed by default.
+	 */
+	void set_TimedSignals(const std::string &names);
+
+	/**
+	 * Add every value that has been set to the tree, in the same string form
+	 * as the decoded Vehicle Basic Message used.  The measurement time of each
+	 * timed value is added in milliseconds since the epoch as the name plus
+	 * "Time", e.g. SpeedTime, unless times is false.
+	 *
+	 * @return The number of values added
+	 */
+	size_t Serialize(tmx::message_tree_type &tree, bool times = true);
+
+	/**
+	 * Same as above, but with the measurement times added to a separate tree,
+	 * so the values can be compared without them
+	 */
+	size_t Serialize(tmx::message_tree_type &values, tmx::message_tree_type &times);
+
+	/**
+	 * @return The number of slot updates since the start
+	 */
+	uint64_t get_Updates() const { return _updates; }
+
+	size_t size() const { return _count; }
+
+	/**
+	 * Copy all the slots to the shared memory segment, and keep it updated.
+	 * The writer must stay open until it is replaced or removed with NULL.
+	 */
+	void Export(SharedVehicleStateWriter *writer);
+
+private:
+	VehicleState();
+
+	struct Slot {
+		// Odd while a write is in progress, and zero if never written
+		std::atomic<uint32_t> seq { 0 };
+
+		std::atomic<uint8_t> type { 0 };
+		std::atomic<int64_t> i { 0 };
+		std::atomic<double> d { 0 };
+		std::atomic<const std::string *> state { nullptr };
+		std::atomic<uint64_t> time { 0 };
+
+		// Number of decoders bound to the slot
+		uint32_t refs { 0 };
+
+		// Set at registration, and the unit again when a slot is reused
+		std::string name;
+		std::string unitSuffix;
+
+		// If the measurement time is sent with the value
+		bool timed { false };
+
+		// If a store wakes up WaitForChange()
+		std::atomic<bool> watched { false };
+	};
+
+	Slot _slots[MaxSlots];
+	std::atomic<size_t> _count { 0 };
+	std::atomic<uint64_t> _updates { 0 };
+
+	// The shared memory export, if enabled
+	std::atomic<SharedVehicleStateWriter *> _shared { nullptr };
+
+	// Set on every store to a watched slot, and signalled if the waiter is asleep
+	std::atomic<bool> _changed { false };
+	std::atomic<bool> _waiting { false };
+	int _changeFd;
+
+	// For registration and serialization
+	std::mutex _lock;
+	std::deque<std::string> _interned;
+	std::set<std::string> _timed;
+
+	uint32_t BeginWrite(Slot &slot);
+	void EndWrite(Slot &slot, uint32_t seq, uint64_t time);
+	size_t SerializeSlots(tmx::message_tree_type &values, tmx::message_tree_type *times);
+};
+
+} /* End namespace VehicleInterfacePlugin */
+
+#endif /* VEHICLESTATE_H_ */
@@ -0,0 +1,116 @@
+/*
+ * CanBusStatistics.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "CanBusStatistics.hpp"
+
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <PluginLog.h>
+
+using namespace std;
+using namespace tmx::utils;
+
+namespace VehicleInterfacePlugin {
+namespace Can {
+
+static mutex _statsLock;
+static map<string, weak_ptr<CanBusStatistics> > _stats;
+
+shared_ptr<CanBusStatistics> CanBusStatistics::ForBus(const string &bus)
+{
+	lock_guard<mutex> lock(_statsLock);
+
+	shared_ptr<CanBusStatistics> stats = _stats[bus].lock();
+	if (!stats)
+	{
+		stats.reset(new CanBusStatistics());
+		stats->bus = bus;
+		_stats[bus] = stats;
+	}
+
+	return stats;
+}
+
+vector<shared_ptr<CanBusStatistics> > CanBusStatistics::All()
+{
+	lock_guard<mutex> lock(_statsLock);
+
+	vector<shared_ptr<CanBusStatistics> > all;
+	for (auto iter = _stats.begin(); iter != _stats.end(); )
+	{
+		shared_ptr<CanBusStatistics> stats = iter->second.lock();
+		if (stats)
+		{
+			all.push_back(stats);
+			iter++;
+		}
+		else
+		{
+			iter = _stats.erase(iter);
+		}
+	}
+
+	return all;
+}
+
+const char *CanBusStatistics::StateName(ControllerState state)
+{
+	switch (state)
+	{
+	case Active:
+		return "Active";
+	case Warning:
+		return "Warning";
+	case Passive:
+		return "Error Passive";
+	case BusOff:
+		return "Bus Off";
+	default:
+		return "Unknown";
+	}
+}
+
+void CanBusStatistics::set_State(ControllerState newState)
+{
+	uint8_t old = state.exchange(newState);
+	if (old == newState)
+		return;
+
+	if (newState == BusOff)
+		busOff++;
+
+	if (newState == Active)
+		PLOG(logINFO) << bus << ": CAN controller is " << StateName(newState) << " again";
+	else
+		PLOG(logWARNING) << bus << ": CAN controller is " << StateName(newState);
+}
+
+string CanBusStatistics::Summary()
+{
+	auto now = chrono::steady_clock::now();
+	uint64_t count = frames;
+	uint64_t totalBits = bits;
+
+	double elapsed = chrono::duration<double>(now - _lastTime).count();
+	double rate = elapsed > 0 ? (count - _lastFrames) / elapsed : 0;
+	double load = (elapsed > 0 && bitRate > 0) ? 100.0 * (totalBits - _lastBits) / (elapsed * bitRate) : 0;
+
+	_lastFrames = count;
+	_lastBits = totalBits;
+	_lastTime = now;
+
+	char buf[256];
+	snprintf(buf, sizeof(buf), "%s, %.1f%% load, %.0f frames/s, %llu frames, %llu unmatched, %llu dropped, "
+			"%llu overflows, %llu errors, %llu bus off",
+			StateName(static_cast<ControllerState>(state.load())), load, rate,
+			(unsigned long long)count, (unsigned long long)unmatched.load(), (unsigned long long)dropped.load(),
+			(unsigned long long)overflows.load(), (unsigned long long)errors.load(), (unsigned long long)busOff.load());
+	return buf;
+}
+
+} /* End namespace Can */
+} /* End namespace VehicleInterfacePlugin */
@@ -0,0 +1,104 @@
+/*
+ * CanBusStatistics.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef WORKERS_CANBUSSTATISTICS_HPP_
+#define WORKERS_CANBUSSTATISTICS_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace VehicleInterfacePlugin {
+namespace Can {
+
+/**
+ * Counters for one CAN bus, shared by the reader and the decoders of the bus.
+ *
+ * There is one set of counters per bus name for as long as any worker holds
+ * it, so the counts survive a reconfiguration of the bus.
+ */
+struct CanBusStatistics {
+	/**
+	 * The error state of the bus controller
+	 */
+	enum ControllerState: uint8_t {
+		Active = 0,
+		Warning,
+		Passive,
+		BusOff
+	};
+
+	std::string bus;
+
+	std::atomic<uint64_t> frames { 0 };
+	std::atomic<uint64_t> fdFrames { 0 };
+	std::atomic<uint64_t> unmatched { 0 };
+
+	// Frames received but not decoded because the decoders fell behind
+	std::atomic<uint64_t> dropped { 0 };
+
+	// Frames lost before they were received, in the socket queue or the controller
+	std::atomic<uint64_t> overflows { 0 };
+
+	// Error frames, or errors reported by the controller
+	std::atomic<uint64_t> errors { 0 };
+
+	// Number of times the controller went bus off
+	std::atomic<uint64_t> busOff { 0 };
+
+	// The estimated number of bits the frames took on the bus, for the bus load
+	std::atomic<uint64_t> bits { 0 };
+	std::atomic<uint32_t> bitRate { 500000 };
+
+	std::atomic<uint8_t> state { Active };
+
+	/**
+	 * Record a change in the controller state, which is logged
+	 */
+	void set_State(ControllerState newState);
+
+	/**
+	 * @return The number of bits a data frame takes on the bus, not counting
+	 * stuff bits, so the bus load is a lower bound.  A CAN FD frame is counted
+	 * as if the data were sent at the nominal bit rate.
+	 */
+	static uint32_t FrameBits(bool extended, size_t len)
+	{
+		// Start of frame to end of frame, plus the intermission
+		return (extended ? 67 : 47) + 8 * len;
+	}
+
+	static const char *StateName(ControllerState state);
+
+	/**
+	 * @return The counters for the bus, created if no worker holds them
+	 */
+	static std::shared_ptr<CanBusStatistics> ForBus(const std::string &bus);
+
+	/**
+	 * @return The counters of every bus in use, in order of the bus name
+	 */
+	static std::vector<std::shared_ptr<CanBusStatistics> > All();
+
+	/**
+	 * @return A summary of the counters, with the frame rate since the last call.
+	 * Only to be called by one thread.
+	 */
+	std::string Summary();
+
+private:
+	uint64_t _lastFrames = 0;
+	uint64_t _lastBits = 0;
+	std::chrono::steady_clock::time_point _lastTime = std::chrono::steady_clock::now();
+};
+
+} /* End namespace Can */
+} /* End namespace VehicleInterfacePlugin */
+
+#endif /* WORKERS_CANBUSSTATISTICS_HPP_ */
@@ -49,6 +49,18 @@ public:
 	std_attribute(this->msg, double, scale, 1.0, );
 	std_attribute(this->msg, double, adjust, 0.0, );
 
+	// Bit-level signal position, which replaces byte, len and mask when set.
+	// The start bit is the least significant bit for Intel order and the most
+	// significant bit for Motorola order, numbered as in a DBC file.
+	std_attribute(this->msg, int16_t, startbit, -1, );
+	std_attribute(this->msg, uint16_t, bitlen, 0, );
+	std_attribute(this->msg, std::string, order, "intel", );
+
+	// The multiplexer signal selects which of the multiplexed signals with a
+	// matching mux value are present in the frame
+	std_attribute(this->msg, bool, multiplexer, false, );
+	std_attribute(this->msg, int32_t, mux, -1, );
+
 	std::string evaluate(const tmx::byte_stream &bytes);
 
 	static tmx::message_tree_type to_tree(CanElementDataAdaptor message)
@@ -0,0 +1,135 @@
+/*
+ * CanDecodePool.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "CanDecodePool.hpp"
+
+#include <PluginLog.h>
+
+using namespace std;
+using namespace tmx::utils;
+
+namespace VehicleInterfacePlugin {
+namespace Can {
+
+CanDecodePool &CanDecodePool::GetPool()
+{
+	static CanDecodePool _pool;
+	return _pool;
+}
+
+size_t CanDecodePool::Acquire(size_t threads)
+{
+	lock_guard<mutex> lock(_lock);
+
+	if (_users++ == 0)
+	{
+		if (threads == 0)
+		{
+			size_t cores = thread::hardware_concurrency();
+			size_t readers = CanBusStatistics::All().size();
+			threads = cores > readers ? cores - readers : 1;
+		}
+
+		PLOG(logINFO) << "Starting " << threads << " CAN decode threads";
+
+		for (size_t i = 0; i < threads; i++)
+		{
+			_lanes.emplace_back(new Lane());
+			Lane &lane = *_lanes.back();
+			lane.thread = thread(&CanDecodePool::Run, this, std::ref(lane));
+		}
+	}
+
+	return _lanes.size();
+}
+
+void CanDecodePool::Release()
+{
+	lock_guard<mutex> lock(_lock);
+
+	if (_users == 0 || --_users > 0)
+		return;
+
+	PLOG(logINFO) << "Stopping " << _lanes.size() << " CAN decode threads";
+
+	for (auto &lane : _lanes)
+	{
+		{
+			lock_guard<mutex> laneLock(lane->lock);
+			lane->stop = true;
+		}
+		lane->ready.notify_one();
+	}
+
+	for (auto &lane : _lanes)
+	{
+		if (lane->thread.joinable())
+			lane->thread.join();
+	}
+
+	_lanes.clear();
+}
+
+bool CanDecodePool::Submit(size_t lane, Batch &batch)
+{
+	if (batch.frames.empty())
+		return true;
+
+	Lane &l = *_lanes[lane];
+	size_t count = batch.frames.size();
+
+	{
+		lock_guard<mutex> lock(l.lock);
+		if (l.queued + count > MaxQueued)
+		{
+			batch.stats->dropped += count;
+			batch.frames.clear();
+			return false;
+		}
+
+		l.queued += count;
+		l.batches.push_back(Batch());
+		l.batches.back().table = batch.table;
+		l.batches.back().stats = batch.stats;
+		l.batches.back().frames.swap(batch.frames);
+	}
+
+	l.ready.notify_one();
+	return true;
+}
+
+void CanDecodePool::Run(Lane &lane)
+{
+	Batch batch;
+
+	while (true)
+	{
+		{
+			unique_lock<mutex> lock(lane.lock);
+			lane.ready.wait(lock, [&lane]() { return lane.stop || !lane.batches.empty(); });
+
+			// The rest of the frames are not decoded once stopped
+			if (lane.stop)
+				break;
+
+			batch = std::move(lane.batches.front());
+			lane.batches.pop_front();
+			lane.queued -= batch.frames.size();
+		}
+
+		for (auto &frame : batch.frames)
+		{
+			if (!batch.table->Dispatch(frame.id, frame.data, frame.len, frame.time))
+				batch.stats->unmatched++;
+		}
+
+		// Let go of the table and counters before waiting
+		batch = Batch();
+	}
+}
+
+} /* End namespace Can */
+} /* End namespace VehicleInterfacePlugin */
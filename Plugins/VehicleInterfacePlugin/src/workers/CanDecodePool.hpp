@@ -0,0 +1,103 @@
+/*
+ * CanDecodePool.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef WORKERS_CANDECODEPOOL_HPP_
+#define WORKERS_CANDECODEPOOL_HPP_
+
+#include "CanBusStatistics.hpp"
+#include "CanRequestTable.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace VehicleInterfacePlugin {
+namespace Can {
+
+/**
+ * Threads shared by all the bus readers to decode the received frames.
+ *
+ * Each decode thread has its own lane, and a frame always goes to the lane
+ * for its CAN id, so the frames of one id are decoded in the order they were
+ * received.  A reader hands over the frames of a whole receive batch at once.
+ * If a lane falls too far behind, new frames are dropped and counted against
+ * their bus rather than held up in the reader.
+ *
+ * The threads are started by the first reader that uses the pool and stopped
+ * when the last one leaves.
+ */
+class CanDecodePool {
+public:
+	// Frames that may wait in one lane
+	static constexpr size_t MaxQueued = 4096;
+
+	struct Frame {
+		canid_t id;
+		uint8_t len;
+		uint64_t time;
+		uint8_t data[CANFD_MAX_DLEN];
+	};
+
+	struct Batch {
+		std::shared_ptr<const CanRequestTable> table;
+		std::shared_ptr<CanBusStatistics> stats;
+		std::vector<Frame> frames;
+	};
+
+	static CanDecodePool &GetPool();
+
+	/**
+	 * Start using the pool, and start the threads if this is the first user
+	 *
+	 * @param threads The number of decode threads, or 0 for one per core
+	 * not used by a bus reader
+	 * @return The number of lanes
+	 */
+	size_t Acquire(size_t threads);
+
+	/**
+	 * Stop using the pool, and stop the threads if this is the last user
+	 */
+	void Release();
+
+	/**
+	 * @return The lane for the CAN id, out of the number returned by Acquire
+	 */
+	static size_t LaneFor(canid_t id, size_t lanes) { return (id ^ (id >> 11)) % lanes; }
+
+	/**
+	 * Queue the batch of frames on the lane.  The batch is left empty.
+	 *
+	 * @return False if the lane is full and the frames were dropped
+	 */
+	bool Submit(size_t lane, Batch &batch);
+
+private:
+	CanDecodePool() { }
+
+	struct Lane {
+		std::mutex lock;
+		std::condition_variable ready;
+		std::deque<Batch> batches;
+		size_t queued = 0;
+		bool stop = false;
+		std::thread thread;
+	};
+
+	std::mutex _lock;
+	size_t _users = 0;
+	std::vector<std::unique_ptr<Lane> > _lanes;
+
+	void Run(Lane &lane);
+};
+
+} /* End namespace Can */
+} /* End namespace VehicleInterfacePlugin */
+
+#endif /* WORKERS_CANDECODEPOOL_HPP_ */
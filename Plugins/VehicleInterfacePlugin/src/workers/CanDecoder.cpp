@@ -0,0 +1,454 @@
+/*
+ * CanDecoder.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "CanDecoder.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <PluginLog.h>
+
+#define ENUM_MISSING "*"
+
+using namespace std;
+using namespace tmx;
+using namespace tmx::messages;
+using namespace tmx::utils;
+
+namespace VehicleInterfacePlugin {
+namespace Can {
+
+CanValueType CanDecoder::TypeByName(const string &name)
+{
+	if (name == "enum")
+		return CanValueType::Enum;
+	else if (name == "int")
+		return CanValueType::Int;
+	else if (name == "double")
+		return CanValueType::Double;
+	else
+		return CanValueType::None;
+}
+
+CanDecoder::CanDecoder(const CanDecoder &copy):
+		_signals(copy._signals), _states(copy._states), _mux(copy._mux), _state(copy._state)
+{
+	Retain();
+}
+
+CanDecoder &CanDecoder::operator=(const CanDecoder &copy)
+{
+	if (this != &copy)
+	{
+		Unbind();
+
+		_signals = copy._signals;
+		_states = copy._states;
+		_mux = copy._mux;
+		_state = copy._state;
+
+		Retain();
+	}
+
+	return *this;
+}
+
+CanDecoder::~CanDecoder()
+{
+	Unbind();
+}
+
+void CanDecoder::Retain()
+{
+	if (!_state)
+		return;
+
+	for (auto &s: _signals)
+		_state->Retain(s.slot);
+}
+
+void CanDecoder::Compile(CanDataAdaptor &config)
+{
+	Unbind();
+
+	_signals.clear();
+	_states.clear();
+	_mux = -1;
+
+	for (CanElementDataAdaptor element: config.get_elements())
+	{
+		if (element.get_enabled())
+			Compile(element);
+	}
+
+	PLOG(logDEBUG1) << config.get_name() << ": Compiled " << _signals.size() << " signals";
+}
+
+bool CanDecoder::Compile(CanElementDataAdaptor &element)
+{
+	CanSignalDescriptor s;
+
+	s.name = element.get_name();
+	s.type = TypeByName(element.get_datatype());
+	if (s.type == CanValueType::None)
+	{
+		PLOG(logWARNING) << "Unknown data type " << element.get_datatype() << " for CAN element " << s.name;
+		return false;
+	}
+
+	if (element.get_startbit() >= 0)
+	{
+		string order = element.get_order();
+		if (order != "intel" && order != "motorola")
+		{
+			PLOG(logWARNING) << "Unknown byte order " << order << " for CAN element " << s.name;
+			return false;
+		}
+
+		if (!Position(s, element.get_startbit(), element.get_bitlen(), order == "motorola"))
+		{
+			PLOG(logWARNING) << "Invalid bit position " << element.get_startbit() << "|" << element.get_bitlen() <<
+					" for CAN element " << s.name;
+			return false;
+		}
+	}
+	else
+	{
+		int len = element.get_len();
+		s.byte = element.get_byte();
+		s.len = abs(len);
+		s.reversed = (len < 0);
+		if (s.len < 1 || s.len > 8)
+		{
+			PLOG(logWARNING) << "Invalid length " << len << " for CAN element " << s.name;
+			return false;
+		}
+
+		s.mask = (uint64_t)-1;
+		if (!element.get_mask().empty())
+			s.mask = strtoull(element.get_mask().c_str(), NULL, 0);
+		s.shift = 0;
+		s.valueMask = s.mask;
+	}
+
+	// The sign is determined by the number of bits in the mask
+	s.isSigned = element.get_signedval();
+	size_t numBits = __builtin_popcountll(s.mask);
+	s.signThreshold = numBits > 0 ? (1ULL << (numBits - 1)) : 0;
+
+	s.mux = element.get_mux();
+	if (element.get_multiplexer())
+	{
+		if (_mux >= 0)
+		{
+			PLOG(logWARNING) << "Ignoring second multiplexer " << s.name;
+			return false;
+		}
+
+		// The multiplexer value is always needed as the raw number
+		s.mux = -1;
+		_mux = _signals.size();
+	}
+
+	s.scale = element.get_scale();
+	s.adjust = element.get_adjust();
+	s.unscaled = (s.scale == 1.0 && s.adjust == 0.0);
+
+	string unit = element.get_unit();
+	if (!unit.empty())
+		s.unitSuffix = (::isalnum(unit[0]) ? " " : "") + unit;
+
+	s.states = 0;
+	s.slot = -1;
+	if (s.type == CanValueType::Enum)
+	{
+		StateTable table;
+		map<uint64_t, const string *> byValue;
+
+		message_container_type c = element.get_container();
+		boost::optional<message_tree_type &> states = c.get_storage().get_tree().get_child_optional("states");
+		if (states)
+		{
+			for (auto iter = states.get().begin(); iter != states.get().end(); iter++)
+			{
+				const string &name = iter->first;
+				string val = iter->second.get_value<string>("");
+				if (val.empty())
+					continue;
+
+				if (val == ENUM_MISSING)
+					table.missing = VehicleState::GetState().Intern(name);
+				else if (::isdigit(val[0]))
+					byValue[strtoull(val.c_str(), NULL, 0)] = VehicleState::GetState().Intern(name);
+			}
+		}
+
+		table.Build(byValue);
+
+		s.states = _states.size();
+		_states.push_back(table);
+	}
+
+	_signals.push_back(s);
+	return true;
+}
+
+bool CanDecoder::Position(CanSignalDescriptor &s, int startBit, int bitLen, bool motorola)
+{
+	if (startBit < 0 || bitLen < 1 || bitLen > 64)
+		return false;
+
+	int bit = startBit % 8;
+	int bytes;
+
+	s.byte = startBit / 8;
+	if (motorola)
+	{
+		// The start bit is the most significant bit, and the bytes are
+		// read in order, so the signal ends up at the bottom of the last byte
+		bytes = (bitLen <= bit + 1) ? 1 : (bitLen - bit - 1 + 7) / 8 + 1;
+		s.shift = (bytes - 1) * 8 + bit + 1 - bitLen;
+		s.reversed = false;
+	}
+	else
+	{
+		// The start bit is the least significant bit, and the bytes are
+		// read in reverse, so the signal starts in the first byte
+		bytes = (bit + bitLen + 7) / 8;
+		s.shift = bit;
+		s.reversed = true;
+	}
+
+	if (bytes > 8)
+		return false;
+
+	s.len = bytes;
+	s.valueMask = (bitLen == 64) ? (uint64_t)-1 : ((1ULL << bitLen) - 1);
+	s.mask = s.valueMask << s.shift;
+	return true;
+}
+
+bool CanDecoder::Extract(const CanSignalDescriptor &s, const uint8_t *data, size_t len, uint64_t &raw)
+{
+	if ((size_t)s.byte + s.len > len)
+		return false;
+
+	const uint8_t *p = data + s.byte;
+	raw = 0;
+	if (s.reversed)
+		for (int i = s.len - 1; i >= 0; i--) raw = (raw << 8) | p[i];
+	else
+		for (int i = 0; i < s.len; i++) raw = (raw << 8) | p[i];
+
+	raw &= s.mask;
+	raw >>= s.shift;
+	return true;
+}
+
+void CanDecoder::StateTable::Build(const map<uint64_t, const string *> &states)
+{
+	dense.clear();
+	sparse.clear();
+
+	for (auto &state: states)
+	{
+		if (state.first < MaxDense)
+		{
+			if (dense.size() <= state.first)
+				dense.resize(state.first + 1, NULL);
+
+			dense[state.first] = state.second;
+		}
+		else
+		{
+			// Already in order from the map
+			sparse.push_back(state);
+		}
+	}
+}
+
+const string *CanDecoder::StateTable::Lookup(uint64_t value) const
+{
+	if (value < dense.size())
+		return dense[value] ? dense[value] : missing;
+
+	if (sparse.empty() || value < MaxDense)
+		return missing;
+
+	auto iter = lower_bound(sparse.begin(), sparse.end(), value,
+			[](const pair<uint64_t, const string *> &state, uint64_t v) { return state.first < v; });
+
+	return (iter != sparse.end() && iter->first == value) ? iter->second : missing;
+}
+
+void CanDecoder::Decode(const uint8_t *data, size_t len, CanValue *values) const
+{
+	// The multiplexer selects the signals that are present in this frame
+	uint64_t muxValue = 0;
+	bool hasMux = (_mux >= 0 && Extract(_signals[_mux], data, len, muxValue));
+
+	for (size_t n = 0; n < _signals.size(); n++)
+	{
+		const CanSignalDescriptor &s = _signals[n];
+		CanValue &v = values[n];
+
+		v.type = s.type;
+		v.state = NULL;
+		v.valid = (s.mux < 0 || (hasMux && muxValue == (uint64_t)s.mux));
+		if (!v.valid)
+			continue;
+
+		uint64_t raw;
+		v.valid = Extract(s, data, len, raw);
+		if (!v.valid)
+			continue;
+
+		int64_t val = (int64_t)raw;
+		if (s.isSigned && raw >= s.signThreshold)
+		{
+			// This is a negative number.  Take two's complement
+			val = -(int64_t)((~raw & s.valueMask) + 1);
+		}
+
+		switch (s.type)
+		{
+		case CanValueType::Double:
+			v.d = (double)val * s.scale + s.adjust;
+			break;
+		case CanValueType::Int:
+			v.i = s.unscaled ? (int32_t)val : (int32_t)((int32_t)val * s.scale + s.adjust);
+			break;
+		case CanValueType::Enum:
+		{
+			uint64_t key = s.unscaled ? (uint64_t)val : (uint64_t)((double)val * s.scale + s.adjust);
+			const StateTable &table = _states[s.states];
+
+			v.state = table.Lookup(key);
+
+			v.i = key;
+			v.valid = (v.state != NULL);
+			break;
+		}
+		default:
+			v.valid = false;
+			break;
+		}
+	}
+}
+
+void CanDecoder::Bind(VehicleState &state)
+{
+	Unbind();
+
+	_state = &state;
+	for (auto &s: _signals)
+		s.slot = state.Register(s.name, s.unitSuffix);
+}
+
+void CanDecoder::Unbind()
+{
+	if (!_state)
+		return;
+
+	for (auto &s: _signals)
+	{
+		_state->Release(s.slot);
+		s.slot = -1;
+	}
+
+	_state = NULL;
+}
+
+void CanDecoder::Update(const uint8_t *data, size_t len, uint64_t time) const
+{
+	if (!_state)
+		return;
+
+	// Most definitions only have a few elements, so avoid the allocation
+	CanValue local[16];
+	vector<CanValue> more;
+
+	CanValue *values = local;
+	if (_signals.size() > 16)
+	{
+		more.resize(_signals.size());
+		values = more.data();
+	}
+
+	Decode(data, len, values);
+
+	// Every value in the frame has the same measurement time
+	if (!time)
+		time = VehicleState::Now();
+
+	VehicleState &state = *_state;
+	for (size_t i = 0; i < _signals.size(); i++)
+	{
+		if (!values[i].valid)
+			continue;
+
+		switch (values[i].type)
+		{
+		case CanValueType::Double:
+			state.SetDouble(_signals[i].slot, values[i].d, time);
+			break;
+		case CanValueType::Int:
+			state.SetInt(_signals[i].slot, values[i].i, time);
+			break;
+		case CanValueType::Enum:
+			state.SetState(_signals[i].slot, values[i].state, time);
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+string CanDecoder::Format(size_t signal, const CanValue &value) const
+{
+	if (!value.valid || signal >= _signals.size())
+		return "";
+
+	char buf[32];
+	switch (value.type)
+	{
+	case CanValueType::Double:
+		// Same as the default stream format
+		snprintf(buf, sizeof(buf), "%g", value.d);
+		break;
+	case CanValueType::Int:
+		snprintf(buf, sizeof(buf), "%lld", (long long)value.i);
+		break;
+	case CanValueType::Enum:
+		return *value.state + _signals[signal].unitSuffix;
+	default:
+		return "";
+	}
+
+	return buf + _signals[signal].unitSuffix;
+}
+
+VehicleBasicMessage CanDecoder::decode_VBM(const uint8_t *data, size_t len) const
+{
+	VehicleBasicMessage vbm;
+	message_tree_type vbmTree;
+
+	vector<CanValue> values(_signals.size());
+	Decode(data, len, values.data());
+
+	for (size_t i = 0; i < _signals.size(); i++)
+	{
+		if (values[i].valid)
+			vbmTree.put(_signals[i].name, Format(i, values[i]));
+	}
+
+	vbm.set_contents(vbmTree);
+	return vbm;
+}
+
+} /* End namespace Can */
+} /* End namespace VehicleInterfacePlugin */
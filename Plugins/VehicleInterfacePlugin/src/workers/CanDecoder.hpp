@@ -0,0 +1,227 @@
+/*
+ * CanDecoder.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef WORKERS_CANDECODER_HPP_
+#define WORKERS_CANDECODER_HPP_
+
+#include "CanData.hpp"
+#include "../VehicleState.h"
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace VehicleInterfacePlugin {
+namespace Can {
+
+/**
+ * The data type of a decoded CAN signal
+ */
+enum class CanValueType: uint8_t {
+	None = 0,
+	Enum,
+	Int,
+	Double
+};
+
+/**
+ * A flattened description of one signal within a CAN frame, compiled from a
+ * CanElementDataAdaptor so that decoding does not touch the property tree.
+ */
+struct CanSignalDescriptor {
+	// The slice of the frame that holds the signal
+	uint8_t byte;
+	uint8_t len;
+
+	// The bytes are little-endian, i.e. a negative len in the configuration
+	bool reversed;
+
+	bool isSigned;
+	CanValueType type;
+
+	// Scale and adjust are both the identity, so integers are kept exact
+	bool unscaled;
+
+	// Right shift applied after masking
+	uint8_t shift;
+
+	uint64_t mask;
+
+	// The mask of the value bits once shifted
+	uint64_t valueMask;
+
+	// Values at or above this are negative when the signal is signed
+	uint64_t signThreshold;
+
+	double scale;
+	double adjust;
+
+	// Index of the state table for an enumeration
+	uint16_t states;
+
+	// The multiplexer value for which this signal is present, or -1 if the
+	// signal is always present
+	int32_t mux;
+
+	// The vehicle state slot to update, or -1 if not bound
+	int slot;
+
+	std::string name;
+
+	// The unit with its separator, ready to append to the value
+	std::string unitSuffix;
+};
+
+/**
+ * A decoded signal value.  Only the member for the signal type is set.
+ */
+struct CanValue {
+	CanValueType type;
+	bool valid;
+
+	union {
+		int64_t i;
+		double d;
+	};
+
+	// The interned state name of an enumeration, or NULL if no state matched
+	const std::string *state;
+};
+
+/**
+ * Decoder for all the elements of one CAN data definition.
+ *
+ * The definition is compiled once when the decoder is built.  Each frame is
+ * then decoded by a single pass over the descriptors with no allocation.
+ */
+class CanDecoder {
+public:
+	CanDecoder(): _mux(-1), _state(NULL) {}
+	CanDecoder(CanDataAdaptor &config): _mux(-1), _state(NULL) { Compile(config); }
+
+	/**
+	 * A copy of a bound decoder holds its own references to the vehicle state slots
+	 */
+	CanDecoder(const CanDecoder &copy);
+	CanDecoder &operator=(const CanDecoder &copy);
+	~CanDecoder();
+
+	/**
+	 * Build the descriptors for all the enabled elements of the definition
+	 */
+	void Compile(CanDataAdaptor &config);
+
+	/**
+	 * Build the descriptor for a single element and add it to the decoder
+	 *
+	 * @return True if the element has a known data type
+	 */
+	bool Compile(CanElementDataAdaptor &element);
+
+	size_t size() const { return _signals.size(); }
+	bool empty() const { return _signals.empty(); }
+	const CanSignalDescriptor &operator[](size_t i) const { return _signals[i]; }
+
+	/**
+	 * Decode the frame.  The values must have room for size() entries.
+	 *
+	 * @param data The frame bytes
+	 * @param len The number of frame bytes
+	 * @param values The decoded value of each signal, in descriptor order
+	 */
+	void Decode(const uint8_t *data, size_t len, CanValue *values) const;
+
+	/**
+	 * Assign a vehicle state slot to each signal
+	 */
+	void Bind(VehicleState &state);
+
+	/**
+	 * Release the vehicle state slots of all the signals
+	 */
+	void Unbind();
+
+	/**
+	 * Decode the frame and store the values in the bound vehicle state slots.
+	 * Nothing is stored if the decoder is not bound.
+	 *
+	 * @param time The time the frame was received, in microseconds since the
+	 * epoch, or zero to use the current time
+	 */
+	void Update(const uint8_t *data, size_t len, uint64_t time = 0) const;
+
+	void Update(const tmx::byte_stream &bytes, uint64_t time = 0) const
+	{
+		Update(bytes.data(), bytes.size(), time);
+	}
+
+	/**
+	 * @return The decoded value as it appears in a vehicle basic message,
+	 * including the unit, or an empty string if there is no value
+	 */
+	std::string Format(size_t signal, const CanValue &value) const;
+
+	/**
+	 * Decode the frame into a vehicle basic message
+	 */
+	tmx::messages::VehicleBasicMessage decode_VBM(const uint8_t *data, size_t len) const;
+
+	tmx::messages::VehicleBasicMessage decode_VBM(const tmx::byte_stream &bytes) const
+	{
+		return decode_VBM(bytes.data(), bytes.size());
+	}
+
+	/**
+	 * @return The data type for the name used in the configuration file
+	 */
+	static CanValueType TypeByName(const std::string &name);
+
+private:
+	/**
+	 * The state names of an enumeration, by value.  Small values are indexed
+	 * directly, and any others are kept sorted for a binary search.
+	 */
+	struct StateTable {
+		static constexpr uint64_t MaxDense = 256;
+
+		std::vector<const std::string *> dense;
+		std::vector<std::pair<uint64_t, const std::string *> > sparse;
+		const std::string *missing = NULL;
+
+		void Build(const std::map<uint64_t, const std::string *> &states);
+		const std::string *Lookup(uint64_t value) const;
+	};
+
+	std::vector<CanSignalDescriptor> _signals;
+	std::vector<StateTable> _states;
+
+	// Index of the multiplexer signal, or -1 if there is none
+	int _mux;
+
+	VehicleState *_state;
+
+	/**
+	 * Set the slice, mask and shift of the signal from the bit position
+	 *
+	 * @return True if the signal fits in a 64 bit raw value
+	 */
+	static bool Position(CanSignalDescriptor &s, int startBit, int bitLen, bool motorola);
+
+	/**
+	 * Read the raw value of the signal from the frame
+	 *
+	 * @return False if the frame is too short for the signal
+	 */
+	static bool Extract(const CanSignalDescriptor &s, const uint8_t *data, size_t len, uint64_t &raw);
+
+	void Retain();
+};
+
+} /* End namespace Can */
+} /* End namespace VehicleInterfacePlugin */
+
+#endif /* WORKERS_CANDECODER_HPP_ */
@@ -0,0 +1,259 @@
+/*
+ * CanLogReader.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "CanLogReader.hpp"
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+#include <linux/can.h>
+
+using namespace std;
+
+namespace VehicleInterfacePlugin {
+namespace Can {
+
+bool CanLogReader::Open(const string &file)
+{
+	Close();
+
+	_file = file;
+	_in.open(file.c_str());
+	return _in.is_open();
+}
+
+void CanLogReader::Close()
+{
+	if (_in.is_open())
+		_in.close();
+
+	_lines = 0;
+	_decimal = false;
+}
+
+void CanLogReader::Rewind()
+{
+	_in.clear();
+	_in.seekg(0);
+	_lines = 0;
+	_decimal = false;
+}
+
+bool CanLogReader::Next(CanLogFrame &frame)
+{
+	string line;
+	while (getline(_in, line))
+	{
+		_lines++;
+
+		if (line.compare(0, 4, "base") == 0)
+			_decimal = (line.find(" dec") != string::npos);
+
+		if (ParseLine(line, frame, _decimal))
+			return true;
+	}
+
+	return false;
+}
+
+/**
+ * @return The time in microseconds from a number of seconds, such as 1436509052.249713
+ */
+static bool ParseTime(const string &token, uint64_t &time)
+{
+	char *end;
+	unsigned long long sec = strtoull(token.c_str(), &end, 10);
+	if (end == token.c_str())
+		return false;
+
+	uint64_t usec = 0;
+	if (*end == '.')
+	{
+		// Keep the first six digits of the fraction
+		int digits = 0;
+		for (end++; ::isdigit(*end); end++)
+		{
+			if (digits++ < 6)
+				usec = usec * 10 + (*end - '0');
+		}
+
+		for (; digits < 6; digits++)
+			usec *= 10;
+	}
+
+	time = (uint64_t)sec * 1000000 + usec;
+	return *end == '\0';
+}
+
+static bool ParseId(const string &token, uint32_t &id, int base = 16)
+{
+	char *end;
+	id = strtoul(token.c_str(), &end, base);
+	if (end == token.c_str())
+		return false;
+
+	// ASC marks an extended id with an x, and candump always prints all eight digits
+	if (*end == 'x' || *end == 'X' || (base == 16 && token.length() == 8))
+		id |= CAN_EFF_FLAG;
+	else if (*end != '\0')
+		return false;
+
+	// Error and remote frames carry their flags in the id, as in 20000080#...
+	if (id & (CAN_ERR_FLAG | CAN_RTR_FLAG))
+		return false;
+
+	if (id & CAN_EFF_FLAG)
+		id = (id & CAN_EFF_MASK) | CAN_EFF_FLAG;
+	else if (id > CAN_SFF_MASK)
+		id |= CAN_EFF_FLAG;
+
+	return true;
+}
+
+static int HexDigit(char c)
+{
+	if (c >= '0' && c <= '9') return c - '0';
+	if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+	return -1;
+}
+
+/**
+ * Parse a candump log frame, such as 123#DEADBEEF, or 123##1DEADBEEF for CAN FD
+ */
+static bool ParseCompact(const string &token, CanLogFrame &frame)
+{
+	size_t hash = token.find('#');
+	if (hash == string::npos || !ParseId(token.substr(0, hash), frame.id))
+		return false;
+
+	size_t i = hash + 1;
+	frame.fd = (i < token.length() && token[i] == '#');
+	if (frame.fd)
+		i += 2;		// The flags nibble
+
+	// Remote frame
+	if (i < token.length() && (token[i] == 'R' || token[i] == 'r'))
+		return false;
+
+	frame.len = 0;
+	while (i + 1 < token.length() && frame.len < sizeof(frame.data))
+	{
+		if (token[i] == '.')
+		{
+			i++;
+			continue;
+		}
+
+		int hi = HexDigit(token[i]);
+		int lo = HexDigit(token[i + 1]);
+		if (hi < 0 || lo < 0)
+			return false;
+
+		frame.data[frame.len++] = (hi << 4) | lo;
+		i += 2;
+	}
+
+	return true;
+}
+
+/**
+ * Parse the data bytes that follow the length in the console or ASC formats
+ */
+static bool ParseBytes(const vector<string> &tokens, size_t first, size_t count, CanLogFrame &frame, int base = 16)
+{
+	if (count > sizeof(frame.data) || first + count > tokens.size())
+		return false;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		char *end;
+		unsigned long val = strtoul(tokens[first + i].c_str(), &end, base);
+		if (*end != '\0' || val > 0xFF)
+			return false;
+
+		frame.data[i] = val;
+	}
+
+	frame.len = count;
+	return true;
+}
+
+bool CanLogReader::ParseLine(const string &line, CanLogFrame &frame, bool decimal)
+{
+	istringstream in(line);
+	vector<string> tokens;
+
+	string token;
+	while (in >> token)
+		tokens.push_back(token);
+
+	if (tokens.empty())
+		return false;
+
+	memset(&frame, 0, sizeof(frame));
+
+	size_t n = 0;
+
+	// The candump formats may start with the time stamp in parentheses
+	if (tokens[0].length() > 2 && tokens[0].front() == '(' && tokens[0].back() == ')')
+	{
+		if (!ParseTime(tokens[0].substr(1, tokens[0].length() - 2), frame.time))
+			return false;
+
+		n++;
+	}
+
+	if (n == 0 && ParseTime(tokens[0], frame.time))
+	{
+		// Vector ASC: time channel id Rx|Tx d len bytes...
+		if (tokens.size() < 6 || !::isdigit(tokens[1][0]))
+			return false;
+
+		if (!ParseId(tokens[2], frame.id, decimal ? 10 : 16))
+			return false;
+
+		size_t d = 3;
+		while (d < tokens.size() && tokens[d] != "d" && tokens[d] != "D")
+		{
+			if (tokens[d] == "r" || tokens[d] == "R")
+				return false;
+			d++;
+		}
+
+		if (d + 1 >= tokens.size())
+			return false;
+
+		size_t len = strtoul(tokens[d + 1].c_str(), NULL, 10);
+		return ParseBytes(tokens, d + 2, len, frame, decimal ? 10 : 16);
+	}
+
+	// Both candump formats name the interface next
+	if (tokens.size() < n + 2)
+		return false;
+	n++;
+
+	if (tokens[n].find('#') != string::npos)
+		return ParseCompact(tokens[n], frame);
+
+	// The candump console format: interface id [len] bytes...
+	if (tokens.size() < n + 2 || !ParseId(tokens[n], frame.id))
+		return false;
+
+	const string &len = tokens[n + 1];
+	if (len.length() < 3 || len.front() != '[' || len.back() != ']')
+		return false;
+
+	// Two length digits are printed for a CAN FD frame
+	frame.fd = (len.length() > 3);
+	return ParseBytes(tokens, n + 2, strtoul(len.c_str() + 1, NULL, 10), frame);
+}
+
+} /* End namespace Can */
+} /* End namespace VehicleInterfacePlugin */
@@ -0,0 +1,84 @@
+/*
+ * CanLogReader.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef WORKERS_CANLOGREADER_HPP_
+#define WORKERS_CANLOGREADER_HPP_
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+namespace VehicleInterfacePlugin {
+namespace Can {
+
+/**
+ * One frame read from a CAN log file
+ */
+struct CanLogFrame {
+	// The CAN id, with CAN_EFF_FLAG set for an extended id
+	uint32_t id;
+
+	// The time of the frame in microseconds from the log, which may be
+	// relative to the start of the log or since the epoch
+	uint64_t time;
+
+	bool fd;
+	uint8_t len;
+	uint8_t data[64];
+};
+
+/**
+ * Reader for text CAN logs, one frame at a time.
+ *
+ * The candump log format (candump -l), the candump console format with or
+ * without time stamps, and the Vector ASC format are all recognized line by
+ * line, so a file may be in any of them.  Remote frames, error frames and
+ * any other lines are skipped.
+ */
+class CanLogReader {
+public:
+	CanLogReader() { }
+	CanLogReader(const std::string &file) { Open(file); }
+
+	bool Open(const std::string &file);
+	bool IsOpen() const { return _in.is_open(); }
+	void Close();
+
+	/**
+	 * Start over from the first frame
+	 */
+	void Rewind();
+
+	/**
+	 * Read the next frame
+	 *
+	 * @return False at the end of the file
+	 */
+	bool Next(CanLogFrame &frame);
+
+	/**
+	 * Parse one line of a log
+	 *
+	 * @param decimal True if the ASC ids and data are in decimal
+	 * @return True if the line holds a data frame
+	 */
+	static bool ParseLine(const std::string &line, CanLogFrame &frame, bool decimal = false);
+
+	uint64_t get_Lines() const { return _lines; }
+
+private:
+	std::string _file;
+	std::ifstream _in;
+	uint64_t _lines = 0;
+
+	// The ASC "base dec" setting
+	bool _decimal = false;
+};
+
+} /* End namespace Can */
+} /* End namespace VehicleInterfacePlugin */
+
+#endif /* WORKERS_CANLOGREADER_HPP_ */
@@ -0,0 +1,237 @@
+/*
+ * CanReplayInterface.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "../workers/CanReplayInterface.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include <PluginLog.h>
+
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <linux/can/raw.h>
+
+using namespace std;
+using namespace tmx;
+using namespace tmx::utils;
+
+namespace VehicleInterfacePlugin {
+namespace Can {
+
+// Create and register an allocator for the log replay, with one worker per file
+static VehicleConnection::GroupedTaskAllocatorImpl<CanReplayInterface> _replayAllocator;
+
+CanReplayInterface::CanReplayInterface(const message &config): _socket(0), _table(new CanRequestTable())
+{
+	_file = GroupKey(config);
+	_output = config.get_untyped("output", "");
+	_speed = config.get<double>("speed", 1.0);
+	_loop = config.get<bool>("loop", false);
+
+	if (_speed < 0)
+		_speed = 0;
+
+	AddRequest(config);
+}
+
+CanReplayInterface::~CanReplayInterface()
+{
+	if (this->_socket > 0)
+		::close(this->_socket);
+}
+
+string CanReplayInterface::GroupKey(const message &config)
+{
+	return config.get_untyped("file", "");
+}
+
+void CanReplayInterface::AddRequest(const message &config)
+{
+	// The frames are decoded by the socketCAN worker instead
+	if (!_output.empty())
+		return;
+
+	shared_ptr<CanRequestTable> table(new CanRequestTable(*atomic_load(&_table)));
+	table->Add(config);
+	atomic_store(&_table, shared_ptr<const CanRequestTable>(table));
+}
+
+void CanReplayInterface::Reconfigure(const vector<message> &configs)
+{
+	if (!_output.empty())
+		return;
+
+	shared_ptr<CanRequestTable> table(new CanRequestTable());
+	for (auto &config : configs)
+		table->Add(config);
+
+	atomic_store(&_table, shared_ptr<const CanRequestTable>(table));
+
+	PLOG(logINFO) << _file << ": Reconfigured with " << table->requests.size() << " CAN ids";
+}
+
+int CanReplayInterface::OpenOutput()
+{
+	int sock = ::socket(PF_CAN, SOCK_RAW, CAN_RAW);
+	if (sock < 0)
+	{
+		PLOG(logERROR) << "Unable to create a socket for " << _output << ": " << strerror(errno);
+		return -1;
+	}
+
+	struct ifreq ifr;
+	memset(&ifr, 0, sizeof(ifr));
+	strncpy(ifr.ifr_name, _output.c_str(), IFNAMSIZ - 1);
+	if (ioctl(sock, SIOCGIFINDEX, &ifr) < 0)
+	{
+		PLOG(logERROR) << "Could not find interface " << _output;
+		::close(sock);
+		return -1;
+	}
+
+	struct sockaddr_can addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.can_family = AF_CAN;
+	addr.can_ifindex = ifr.ifr_ifindex;
+	if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+	{
+		PLOG(logERROR) << "Error binding the socket to " << _output;
+		::close(sock);
+		return -1;
+	}
+
+	int enableFd = 1;
+	setsockopt(sock, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &enableFd, sizeof(enableFd));
+
+	return sock;
+}
+
+bool CanReplayInterface::Write(const CanLogFrame &frame)
+{
+	struct canfd_frame out;
+	memset(&out, 0, sizeof(out));
+	out.can_id = frame.id;
+	out.len = frame.len;
+	memcpy(out.data, frame.data, frame.len);
+
+	size_t mtu = frame.fd ? CANFD_MTU : CAN_MTU;
+	if (!frame.fd && out.len > CAN_MAX_DLEN)
+		out.len = CAN_MAX_DLEN;
+
+	return ::write(this->_socket, &out, mtu) == (ssize_t)mtu;
+}
+
+/**
+ * Play the rest of the file once
+ */
+void CanReplayInterface::Play(CanLogReader &reader)
+{
+	typedef std::chrono::steady_clock clock;
+
+	CanLogFrame frame;
+	uint64_t first = 0;
+	uint64_t frames = 0;
+	uint64_t unmatched = 0;
+	clock::duration decoding = clock::duration::zero();
+
+	clock::time_point start = clock::now();
+
+	while (IsRunning() && reader.Next(frame))
+	{
+		if (frames == 0)
+			first = frame.time;
+
+		// Keep the original spacing of the frames
+		if (_speed > 0 && frame.time > first)
+		{
+			auto offset = std::chrono::microseconds((uint64_t)((frame.time - first) / _speed));
+			this_thread::sleep_until(start + offset);
+		}
+
+		frames++;
+
+		if (this->_socket > 0)
+		{
+			if (!Write(frame))
+				PLOG(logDEBUG2) << _output << ": Unable to write frame: " << strerror(errno);
+			continue;
+		}
+
+		shared_ptr<const CanRequestTable> table = atomic_load(&_table);
+
+		clock::time_point before = clock::now();
+		if (!table->Dispatch(frame.id, frame.data, frame.len, 0))
+			unmatched++;
+		decoding += clock::now() - before;
+	}
+
+	_frames += frames;
+	_unmatched += unmatched;
+	_passes++;
+
+	double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+	double decodeTime = std::chrono::duration<double>(decoding).count();
+
+	PLOG(logINFO) << _file << ": Replayed " << frames << " frames (" << unmatched << " unmatched) in " <<
+			elapsed << " s, " << (elapsed > 0 ? frames / elapsed : 0) << " frames/s";
+
+	if (frames > unmatched && decodeTime > 0)
+		PLOG(logINFO) << _file << ": Decoded " << (frames - unmatched) / decodeTime << " frames/s, " <<
+				decodeTime * 1e9 / (frames - unmatched) << " ns per frame";
+}
+
+void CanReplayInterface::DoWork()
+{
+	int threadId = VehicleConnection::GetConnection()->this_thread();
+
+	CanLogReader reader;
+	if (!reader.Open(_file))
+	{
+		PLOG(logERROR) << "Unable to open CAN log file " << _file;
+		this->_active = false;
+		return;
+	}
+
+	if (!_output.empty())
+	{
+		this->_socket = OpenOutput();
+		if (this->_socket <= 0)
+		{
+			this->_socket = 0;
+			this->_active = false;
+			return;
+		}
+	}
+
+	PLOG(logINFO) << "Thread " << threadId << " (" << this_thread::get_id() << ") replaying " << _file <<
+			(_output.empty() ? "" : " to ") << _output << " at " << _speed << "x speed has been started.";
+
+	while (IsRunning())
+	{
+		Play(reader);
+
+		if (!_loop)
+			break;
+
+		reader.Rewind();
+	}
+
+	// Stay running until stopped, so the connection does not see a failed worker
+	while (IsRunning())
+		this_thread::sleep_for(std::chrono::milliseconds(200));
+
+	PLOG(logINFO) << "Thread " << threadId << " (" << this_thread::get_id() << ") is exiting.";
+
+	this->_active = false;
+}
+
+} /* End namespace Can */
+} /* End namespace VehicleInterfacePlugin */
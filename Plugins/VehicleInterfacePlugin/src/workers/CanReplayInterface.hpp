@@ -0,0 +1,86 @@
+/*
+ * CanReplayInterface.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef WORKERS_CANREPLAYINTERFACE_HPP_
+#define WORKERS_CANREPLAYINTERFACE_HPP_
+
+#include "../VehicleConnection.h"
+#include "../workers/CanLogReader.hpp"
+#include "../workers/CanRequestTable.hpp"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace VehicleInterfacePlugin {
+namespace Can {
+
+/**
+ * Source of CAN frames from a log file instead of a vehicle bus.
+ *
+ * All the requests that name the same file are handled by one worker.  The
+ * frames are played back with their original spacing, scaled by the
+ * "speed" of the driver, or as fast as possible for a speed of 0.  Each
+ * frame is either decoded directly with the compiled requests, or written
+ * to the socketCAN bus named by "output", such as vcan0, where a socketCAN
+ * worker reads it like any other bus.
+ *
+ * The playback rate and decode throughput are logged at the end of each
+ * pass through the file.  With "loop" set, the file is played again.
+ */
+class CanReplayInterface: public tmx::utils::ThreadWorker {
+public:
+	static constexpr const char *TaskName = "replay";
+
+	CanReplayInterface(const tmx::message &config);
+	virtual ~CanReplayInterface();
+
+	/**
+	 * @return The log file name, which groups the requests into one worker
+	 */
+	static std::string GroupKey(const tmx::message &config);
+
+	/**
+	 * Add another CAN id request from the same file.  Must be called before
+	 * the worker is started.
+	 */
+	void AddRequest(const tmx::message &config);
+
+	/**
+	 * Replace all the requests without stopping the playback
+	 */
+	void Reconfigure(const std::vector<tmx::message> &configs);
+
+	void DoWork();
+
+	uint64_t get_Frames() const { return _frames; }
+	uint64_t get_Unmatched() const { return _unmatched; }
+	uint64_t get_Passes() const { return _passes; }
+
+private:
+	std::string _file;
+	std::string _output;
+	double _speed;
+	bool _loop;
+
+	int _socket;
+
+	// Only accessed through the atomic shared_ptr functions
+	std::shared_ptr<const CanRequestTable> _table;
+
+	std::atomic<uint64_t> _frames { 0 };
+	std::atomic<uint64_t> _unmatched { 0 };
+	std::atomic<uint64_t> _passes { 0 };
+
+	int OpenOutput();
+	bool Write(const CanLogFrame &frame);
+	void Play(CanLogReader &reader);
+};
+
+} /* End namespace Can */
+} /* End namespace VehicleInterfacePlugin */
+
+#endif /* WORKERS_CANREPLAYINTERFACE_HPP_ */
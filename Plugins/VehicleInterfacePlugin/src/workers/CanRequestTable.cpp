@@ -0,0 +1,87 @@
+/*
+ * CanRequestTable.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "CanRequestTable.hpp"
+
+#include <algorithm>
+
+using namespace std;
+using namespace tmx;
+
+namespace VehicleInterfacePlugin {
+namespace Can {
+
+// Orders the requests against a mask and masked id to look up
+struct RequestKey {
+	canid_t key;
+	canid_t mask;
+
+	bool operator()(const CanRequestTable::Request &r, const RequestKey &k) const
+	{
+		return r.mask < k.mask || (r.mask == k.mask && r.key < k.key);
+	}
+
+	bool operator()(const RequestKey &k, const CanRequestTable::Request &r) const
+	{
+		return k.mask < r.mask || (k.mask == r.mask && k.key < r.key);
+	}
+};
+
+void CanRequestTable::Add(const message &config)
+{
+	Request req;
+	req.canData = CanDataAdaptor(config.get_container());
+	if (req.canData.is_empty() || !req.canData.get_enabled())
+		return;
+
+	req.mask = MaskByName(req.canData.get_mask());
+	req.key = strtoul(req.canData.get_id().c_str(), NULL, 0) & req.mask;
+	req.decoder.Compile(req.canData);
+	req.decoder.Bind(VehicleState::GetState());
+
+	requests.insert(upper_bound(requests.begin(), requests.end(), req), req);
+
+	if (find(masks.begin(), masks.end(), req.mask) == masks.end())
+		masks.push_back(req.mask);
+}
+
+bool CanRequestTable::SameFilters(const CanRequestTable &other) const
+{
+	if (requests.size() != other.requests.size())
+		return false;
+
+	for (size_t i = 0; i < requests.size(); i++)
+	{
+		if (requests[i].key != other.requests[i].key || requests[i].mask != other.requests[i].mask)
+			return false;
+	}
+
+	return true;
+}
+
+bool CanRequestTable::Dispatch(canid_t id, const uint8_t *data, size_t len, uint64_t time) const
+{
+	bool matched = false;
+
+	for (canid_t mask : masks)
+	{
+		RequestKey find;
+		find.mask = mask;
+		find.key = id & mask;
+
+		auto range = equal_range(requests.begin(), requests.end(), find, find);
+		for (auto iter = range.first; iter != range.second; iter++)
+		{
+			iter->decoder.Update(data, len, time);
+			matched = true;
+		}
+	}
+
+	return matched;
+}
+
+} /* End namespace Can */
+} /* End namespace VehicleInterfacePlugin */
@@ -0,0 +1,65 @@
+/*
+ * CanRequestTable.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef WORKERS_CANREQUESTTABLE_HPP_
+#define WORKERS_CANREQUESTTABLE_HPP_
+
+#include "CanData.hpp"
+#include "CanDecoder.hpp"
+
+#include <vector>
+
+namespace VehicleInterfacePlugin {
+namespace Can {
+
+/**
+ * The compiled CAN data requests for one source of frames, sorted so the
+ * decoder for a received id is found with a binary search per distinct mask.
+ *
+ * A table is not changed once it is in use.  A source that is reconfigured
+ * builds a new table and swaps it in whole.
+ */
+struct CanRequestTable {
+	struct Request {
+		canid_t key;
+		canid_t mask;
+		CanDataAdaptor canData;
+		CanDecoder decoder;
+
+		bool operator<(const Request &other) const
+		{
+			return mask < other.mask || (mask == other.mask && key < other.key);
+		}
+	};
+
+	// Sorted by mask, then by masked id
+	std::vector<Request> requests;
+
+	// The distinct masks in the requests
+	std::vector<canid_t> masks;
+
+	/**
+	 * Compile the request and bind it to the vehicle state
+	 */
+	void Add(const tmx::message &config);
+
+	/**
+	 * @return True if both tables need the same kernel filters
+	 */
+	bool SameFilters(const CanRequestTable &other) const;
+
+	/**
+	 * Decode the frame with every request that matches the id
+	 *
+	 * @return False if no request matched
+	 */
+	bool Dispatch(canid_t id, const uint8_t *data, size_t len, uint64_t time) const;
+};
+
+} /* End namespace Can */
+} /* End namespace VehicleInterfacePlugin */
+
+#endif /* WORKERS_CANREQUESTTABLE_HPP_ */
@@ -0,0 +1,143 @@
+/*
+ * ODBIIFrame.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef WORKERS_ODBIIFRAME_HPP_
+#define WORKERS_ODBIIFRAME_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace VehicleInterfacePlugin {
+namespace Can {
+namespace ODBII {
+
+/**
+ * ISO-TP frame types, from the upper nibble of the first byte
+ */
+enum class ODBIIFrameType: uint8_t {
+	Single = 0,
+	First = 1,
+	Consecutive = 2,
+	FlowControl = 3
+};
+
+/**
+ * A read-only view of the data bytes of one ODB-II CAN frame.
+ *
+ * Nothing is copied or decoded up front; each accessor reads its field
+ * straight from the frame bytes.  The frame must outlive the view.  Use
+ * ODBIIMessage only when the frame needs to be logged or routed.
+ */
+struct ODBIIFrame {
+	static constexpr size_t size = 8;
+
+	const uint8_t *data;
+	size_t len;
+
+	constexpr ODBIIFrame(const uint8_t *bytes, size_t n): data(bytes), len(n < size ? n : size) { }
+
+	constexpr ODBIIFrameType get_FrameType() const
+	{
+		return static_cast<ODBIIFrameType>(len > 0 ? data[0] >> 4 : 0x0F);
+	}
+
+	/**
+	 * @return The number of bytes that follow the length byte of a single frame
+	 */
+	constexpr uint8_t get_Length() const
+	{
+		return len > 0 ? data[0] & 0x0F : 0;
+	}
+
+	/**
+	 * @return The total size of the response that starts with this first frame
+	 */
+	constexpr uint16_t get_FirstLength() const
+	{
+		return len > 1 ? ((data[0] & 0x0F) << 8) | data[1] : 0;
+	}
+
+	/**
+	 * @return The sequence number of a consecutive frame
+	 */
+	constexpr uint8_t get_Sequence() const
+	{
+		return len > 0 ? data[0] & 0x0F : 0;
+	}
+
+	/**
+	 * @return True if this is a single frame whose length fits in the frame
+	 */
+	constexpr bool isValid() const
+	{
+		return get_FrameType() == ODBIIFrameType::Single && get_Length() > 0 && (size_t)get_Length() < len;
+	}
+
+	/**
+	 * @return The bytes that follow the length byte of a single frame
+	 */
+	constexpr const uint8_t *get_Payload() const
+	{
+		return &data[1];
+	}
+
+	constexpr size_t get_Payload_length() const
+	{
+		return isValid() ? get_Length() : 0;
+	}
+
+	constexpr uint8_t get_Service() const
+	{
+		return isValid() ? data[1] : 0;
+	}
+
+	/**
+	 * @return True if this message is a request type, as determined by the service number
+	 */
+	constexpr bool isRequest() const
+	{
+		return get_Service() < 0x40;
+	}
+
+	/**
+	 * @return True if this message is an SAE standard request or response, as determined by the service number
+	 */
+	constexpr bool isSAEStandard() const
+	{
+		return isRequest() ? get_Service() <= 0x0A : get_Service() <= 0x4A;
+	}
+
+	constexpr size_t getNumPIDBytes() const
+	{
+		return isSAEStandard() ? 1 : 2;
+	}
+
+	constexpr uint16_t get_PID() const
+	{
+		return get_Payload_length() < 1 + getNumPIDBytes() ? 0 :
+				getNumPIDBytes() == 1 ? data[2] : (data[2] << 8) | data[3];
+	}
+
+	/**
+	 * @return The data value bytes that follow the PID of a response
+	 */
+	constexpr const uint8_t *get_Value_data() const
+	{
+		return &data[2 + getNumPIDBytes()];
+	}
+
+	constexpr size_t get_Value_length() const
+	{
+		return (isRequest() || get_Payload_length() < 1 + getNumPIDBytes()) ? 0 :
+				get_Payload_length() - 1 - getNumPIDBytes();
+	}
+};
+
+} /* End namespace ODBII */
+} /* End namespace Can */
+} /* End namespace VehicleInterfacePlugin */
+
+#endif /* WORKERS_ODBIIFRAME_HPP_ */
@@ -10,6 +10,8 @@
 
 #define ECU_BROADCAST_ADDR 0x7DF
 
+#include "ODBIIFrame.hpp"
+
 #include <tmx/messages/message.hpp>
 #include <tmx/messages/byte_stream.hpp>
 #include <tmx/TmxException.hpp>
@@ -32,6 +34,17 @@ public:
 	 * Copy an ODB-II message
 	 */
 	ODBIIMessage(const ODBIIMessage &copy): tmx::message(copy) { }
+
+	/**
+	 * Decode an ODB-II message from a raw frame, e.g. for logging
+	 *
+	 * @param frame The view of the frame bytes
+	 * @param address The CAN id the frame was received from
+	 */
+	ODBIIMessage(const ODBIIFrame &frame, Address::data_type address) {
+		this->set_Address(address);
+		this->decode(frame);
+	}
 	virtual ~ODBIIMessage() {}
 
 	static constexpr const char *MsgType = "ODB-II";
@@ -126,39 +139,38 @@ public:
 	void decode(const tmx::byte_stream &bytes) {
 		static constexpr const size_t addrSz = sizeof(Address::data_type);
 
-		tmx::byte_stream copy(bytes);
-
-		if (copy.size() < addrSz)
+		if (bytes.size() < addrSz)
 			return;
 
-		this->set_Address(this->to_value<Address::data_type>(copy.begin(), copy.begin() + addrSz));
-		copy.erase(copy.begin(), copy.begin() + addrSz);
+		this->set_Address(this->to_value<Address::data_type>(bytes.begin(), bytes.begin() + addrSz));
 
-		if (copy.size() < 1)
-			return;
-
-		this->set_Length(this->to_value<Length::data_type>(copy.begin(), copy.begin() + 1));
-		copy.erase(copy.begin());
+		this->decode(ODBIIFrame(bytes.data() + addrSz, bytes.size() - addrSz));
+	}
 
-		// Check the remaining bytes matches the correct length.
-		int bytesLeft = this->get_Length();
-		if (bytesLeft <= 0 || bytesLeft > (int)(size - 1))
+	/**
+	 * Decodes the fields of a raw frame, without the address
+	 *
+	 * @param frame The view of the frame bytes
+	 */
+	void decode(const ODBIIFrame &frame) {
+		if (frame.len < 1)
 			return;
 
-		// Truncate any unnecessary bytes
-		copy.resize(bytesLeft);
+		this->set_Length(frame.get_Length());
 
-		if (copy.size() < 1)
+		// Check the remaining bytes matches the correct length.
+		if (!frame.isValid())
 			return;
 
-		this->set_Service(this->to_value<Service::data_type>(copy.begin(), copy.begin() + 1));
-		copy.erase(copy.begin());
+		this->set_Service(frame.get_Service());
+		this->set_PID(frame.get_PID());
 
-		this->set_PID_bytes(copy);
-		copy.erase(copy.begin(), copy.begin() + this->getNumPIDBytes());
+		size_t n = frame.get_Value_length();
+		if (n > sizeof(Value::data_type))
+			n = sizeof(Value::data_type);
 
-		if (copy.size() > 0)
-			this->set_Value_bytes(copy);
+		if (n > 0)
+			this->set_Value(this->to_value<Value::data_type>(frame.get_Value_data(), frame.get_Value_data() + n));
 	}
 
 	/**
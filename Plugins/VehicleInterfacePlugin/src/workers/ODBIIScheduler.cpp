@@ -0,0 +1,475 @@
+/*
+ * ODBIIScheduler.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "ODBIIScheduler.hpp"
+#include "ODBIIMessage.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <PluginLog.h>
+
+// The first and last physical response addresses of the 11-bit ECUs
+#define ECU_RESPONSE_FIRST 0x7E8
+#define ECU_RESPONSE_LAST 0x7EF
+
+// Distance from a response address to the physical request address of the same ECU
+#define ECU_RESPONSE_OFFSET 8
+
+// Filler for the unused bytes of a frame
+#define ODBII_PAD 0x55
+
+using namespace std;
+using namespace tmx;
+using namespace tmx::utils;
+
+namespace VehicleInterfacePlugin {
+namespace Can {
+namespace ODBII {
+
+/**
+ * Number of data bytes for each SAE J1979 mode 01 PID, or zero for those
+ * with a variable or unknown length, which are never batched
+ */
+static const uint8_t _mode1Lengths[256] = {
+	/* 0x00 */ 4, 4, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 2, 1, 1, 1,
+	/* 0x10 */ 2, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1, 2,
+	/* 0x20 */ 4, 2, 2, 2, 4, 4, 4, 4, 4, 4, 4, 4, 1, 1, 1, 1,
+	/* 0x30 */ 1, 2, 2, 1, 4, 4, 4, 4, 4, 4, 4, 4, 2, 2, 2, 2,
+	/* 0x40 */ 4, 4, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 4,
+	/* 0x50 */ 4, 1, 1, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1, 2, 2, 1,
+	/* 0x60 */ 4, 1, 1, 2, 5
+};
+
+uint8_t ODBIIScheduler::PidLength(uint8_t pid)
+{
+	return _mode1Lengths[pid];
+}
+
+ODBIIScheduler::ODBIIScheduler(): _timeout(100), _lastHandle(0), _inFlightCount(0)
+{
+	memset(_mode1, -1, sizeof(_mode1));
+	memset(_ecus, 0, sizeof(_ecus));
+}
+
+void ODBIIScheduler::Split(uint32_t svcPid, uint8_t &service, uint16_t &pid)
+{
+	// Same encoding as the ODB-II request message
+	if ((svcPid & 0xFFFF) == svcPid)
+	{
+		service = (svcPid >> 8) & 0xFF;
+		pid = svcPid & 0xFF;
+	}
+	else
+	{
+		service = (svcPid >> 16) & 0xFF;
+		pid = svcPid & 0xFFFF;
+	}
+}
+
+ODBIIScheduler::handle_type ODBIIScheduler::Add(uint32_t svcPid, chrono::milliseconds period, const CanDecoder &decoder)
+{
+	uint8_t service;
+	uint16_t pid;
+	Split(svcPid, service, pid);
+
+	lock_guard<mutex> lock(_lock);
+
+	Registration reg;
+	reg.handle = ++_lastHandle;
+	reg.period = period;
+	reg.decoder = decoder;
+
+	Pid *existing = Find(service, pid);
+	if (existing)
+	{
+		existing->users.push_back(reg);
+		existing->period = min(existing->period, period);
+	}
+	else
+	{
+		Pid entry;
+		entry.service = service;
+		entry.pid = pid;
+		entry.length = (service == 0x01 ? PidLength(pid) : 0);
+		entry.period = period;
+		entry.nextDue = clock_type::now();
+		entry.inFlight = false;
+		entry.users.push_back(reg);
+
+		_pids.push_back(entry);
+	}
+
+	Sort();
+
+	PLOG(logDEBUG) << "Scheduled ODB-II service " << (int)service << " PID " << pid <<
+			" every " << period.count() << " ms";
+
+	return reg.handle;
+}
+
+void ODBIIScheduler::Remove(handle_type handle)
+{
+	lock_guard<mutex> lock(_lock);
+
+	for (auto iter = _pids.begin(); iter != _pids.end(); iter++)
+	{
+		auto &users = iter->users;
+		auto user = find_if(users.begin(), users.end(),
+				[handle](const Registration &r) { return r.handle == handle; });
+		if (user == users.end())
+			continue;
+
+		users.erase(user);
+		if (users.empty())
+		{
+			_pids.erase(iter);
+		}
+		else
+		{
+			iter->period = users[0].period;
+			for (auto &r: users)
+				iter->period = min(iter->period, r.period);
+		}
+
+		Sort();
+		return;
+	}
+}
+
+void ODBIIScheduler::Sort()
+{
+	// Keep the fastest PIDs first, otherwise in the order they were added
+	stable_sort(_pids.begin(), _pids.end(),
+			[](const Pid &a, const Pid &b) { return a.period < b.period; });
+
+	Reindex();
+}
+
+bool ODBIIScheduler::empty()
+{
+	lock_guard<mutex> lock(_lock);
+	return _pids.empty();
+}
+
+void ODBIIScheduler::set_Transmit(transmit_function transmit)
+{
+	lock_guard<mutex> lock(_lock);
+	_transmit = transmit;
+}
+
+void ODBIIScheduler::set_Timeout(chrono::milliseconds timeout)
+{
+	lock_guard<mutex> lock(_lock);
+	_timeout = timeout;
+}
+
+void ODBIIScheduler::Reindex()
+{
+	memset(_mode1, -1, sizeof(_mode1));
+	for (size_t i = 0; i < _pids.size(); i++)
+	{
+		if (_pids[i].service == 0x01 && _pids[i].pid < 256)
+			_mode1[_pids[i].pid] = i;
+	}
+}
+
+ODBIIScheduler::Pid *ODBIIScheduler::Find(uint8_t service, uint16_t pid)
+{
+	if (service == 0x01)
+	{
+		if (pid < 256 && _mode1[pid] >= 0)
+			return &_pids[_mode1[pid]];
+		return NULL;
+	}
+
+	for (auto &p: _pids)
+	{
+		if (p.service == service && p.pid == pid)
+			return &p;
+	}
+
+	return NULL;
+}
+
+void ODBIIScheduler::Send(Pending &request)
+{
+	uint8_t data[8];
+	memset(data, ODBII_PAD, sizeof(data));
+
+	// Single frame, with the length in the first byte
+	size_t n = 1;
+	data[n++] = request.service;
+	for (size_t i = 0; i < request.count; i++)
+	{
+		if (request.pids[i] > 0xFF)
+			data[n++] = (request.pids[i] >> 8) & 0xFF;
+		data[n++] = request.pids[i] & 0xFF;
+	}
+	data[0] = n - 1;
+
+	_requests++;
+
+	if (_transmit && !_transmit(ECU_BROADCAST_ADDR, data, sizeof(data)))
+		PLOG(logWARNING) << "Unable to queue ODB-II request for service " << (int)request.service;
+}
+
+void ODBIIScheduler::Release(Pending &request)
+{
+	for (size_t i = 0; i < request.count; i++)
+	{
+		Pid *p = Find(request.service, request.pids[i]);
+		if (p)
+			p->inFlight = false;
+	}
+}
+
+ODBIIScheduler::clock_type::time_point ODBIIScheduler::Poll(clock_type::time_point now)
+{
+	lock_guard<mutex> lock(_lock);
+
+	// Abandon the requests with no response in time
+	for (size_t i = 0; i < _inFlightCount; )
+	{
+		if (_inFlight[i].deadline <= now)
+		{
+			_timeouts++;
+			Release(_inFlight[i]);
+			_inFlight[i] = _inFlight[--_inFlightCount];
+		}
+		else
+		{
+			i++;
+		}
+	}
+
+	while (_inFlightCount < MaxInFlight)
+	{
+		Pending &request = _inFlight[_inFlightCount];
+		request.count = 0;
+
+		// Only PIDs with a known length in mode 01 can share a request
+		bool batch = false;
+
+		for (auto &p: _pids)
+		{
+			if (p.inFlight || p.nextDue > now)
+				continue;
+
+			bool batchable = (p.service == 0x01 && p.length > 0);
+			if (request.count == 0)
+			{
+				request.service = p.service;
+				batch = batchable;
+			}
+			else if (!batchable)
+			{
+				continue;
+			}
+
+			request.pids[request.count++] = p.pid;
+			p.inFlight = true;
+
+			// Keep the schedule, unless it has fallen a whole period behind
+			p.nextDue += p.period;
+			if (p.nextDue <= now)
+				p.nextDue = now + p.period;
+
+			if (!batch || request.count >= MaxPidsPerRequest)
+				break;
+		}
+
+		if (request.count == 0)
+			break;
+
+		request.deadline = now + _timeout;
+		_inFlightCount++;
+
+		Send(request);
+	}
+
+	// Wake up for the next PID due, or the next request to expire
+	clock_type::time_point next = now + chrono::milliseconds(200);
+	for (size_t i = 0; i < _inFlightCount; i++)
+		next = min(next, _inFlight[i].deadline);
+
+	if (_inFlightCount < MaxInFlight)
+	{
+		for (auto &p: _pids)
+		{
+			if (!p.inFlight)
+				next = min(next, p.nextDue);
+		}
+	}
+
+	return next;
+}
+
+void ODBIIScheduler::Complete(uint8_t service, uint16_t pid)
+{
+	for (size_t i = 0; i < _inFlightCount; i++)
+	{
+		Pending &request = _inFlight[i];
+		if (request.service != service)
+			continue;
+
+		for (size_t j = 0; j < request.count; j++)
+		{
+			if (request.pids[j] == pid)
+			{
+				Release(request);
+				_inFlight[i] = _inFlight[--_inFlightCount];
+				return;
+			}
+		}
+	}
+}
+
+void ODBIIScheduler::Decode(Pid &p, const uint8_t *data, size_t len, uint64_t time)
+{
+	for (auto &r: p.users)
+		r.decoder.Update(data, len, time);
+}
+
+void ODBIIScheduler::HandleResponse(const uint8_t *data, size_t len, uint64_t time)
+{
+	// A positive response has 0x40 added to the service
+	if (len < 2 || data[0] < 0x40 || data[0] == 0x7F)
+		return;
+
+	uint8_t service = data[0] - 0x40;
+
+	_responses++;
+
+	if (service == 0x01)
+	{
+		// Any number of PID and value pairs
+		bool first = true;
+		for (size_t i = 1; i < len; )
+		{
+			uint8_t pid = data[i];
+			Pid *p = Find(service, pid);
+
+			size_t n = p ? p->length : PidLength(pid);
+			if (n == 0 && p && first)
+				n = len - i - 1;
+
+			if (n == 0 || i + 1 + n > len)
+				break;
+
+			if (p)
+				Decode(*p, &data[i + 1], n, time);
+
+			if (first)
+				Complete(service, pid);
+
+			first = false;
+			i += 1 + n;
+		}
+	}
+	else
+	{
+		// One PID, with two bytes if not an SAE standard service
+		size_t pidLen = (data[0] <= 0x4A ? 1 : 2);
+		if (len <= pidLen)
+			return;
+
+		uint16_t pid = data[1];
+		if (pidLen == 2)
+			pid = (pid << 8) | data[2];
+
+		Pid *p = Find(service, pid);
+		if (p)
+			Decode(*p, &data[1 + pidLen], len - 1 - pidLen, time);
+
+		Complete(service, pid);
+	}
+}
+
+bool ODBIIScheduler::Received(uint32_t id, const uint8_t *data, size_t len, uint64_t time)
+{
+	if (id < ECU_RESPONSE_FIRST || id > ECU_RESPONSE_LAST || len < 1)
+		return false;
+
+	lock_guard<mutex> lock(_lock);
+
+	if (_pids.empty())
+		return false;
+
+	Reassembly &ecu = _ecus[id - ECU_RESPONSE_FIRST];
+	ODBIIFrame frame(data, len);
+
+	switch (frame.get_FrameType())
+	{
+	case ODBIIFrameType::Single:
+		PLOG(logDEBUG3) << "Received ODB-II response: " << ODBIIMessage(frame, id);
+
+		ecu.active = false;
+		HandleResponse(frame.get_Payload(), frame.get_Payload_length(), time);
+		break;
+	case ODBIIFrameType::First:
+	{
+		// First frame of a longer response
+		if (frame.len < 2)
+			break;
+
+		ecu.expected = frame.get_FirstLength();
+		if (ecu.expected > MaxResponse)
+		{
+			PLOG(logDEBUG) << "Ignoring ODB-II response of " << ecu.expected << " bytes from " << id;
+			ecu.active = false;
+			break;
+		}
+
+		ecu.received = min(frame.len - 2, ecu.expected);
+		memcpy(ecu.data, &data[2], ecu.received);
+		ecu.nextSeq = 1;
+		ecu.active = true;
+
+		// Ask for the rest with no delay between the frames
+		uint8_t flow[8];
+		memset(flow, ODBII_PAD, sizeof(flow));
+		flow[0] = 0x30;
+		flow[1] = 0x00;
+		flow[2] = 0x00;
+
+		if (_transmit)
+			_transmit(id - ECU_RESPONSE_OFFSET, flow, sizeof(flow));
+		break;
+	}
+	case ODBIIFrameType::Consecutive:
+	{
+		if (!ecu.active)
+			break;
+
+		if (frame.get_Sequence() != ecu.nextSeq)
+		{
+			PLOG(logDEBUG) << "Out of sequence ODB-II frame from " << id;
+			ecu.active = false;
+			break;
+		}
+
+		size_t n = min(frame.len - 1, ecu.expected - ecu.received);
+		memcpy(&ecu.data[ecu.received], &data[1], n);
+		ecu.received += n;
+		ecu.nextSeq = (ecu.nextSeq + 1) & 0x0F;
+
+		if (ecu.received >= ecu.expected)
+		{
+			ecu.active = false;
+			HandleResponse(ecu.data, ecu.received, time);
+		}
+		break;
+	}
+	default:
+		break;
+	}
+
+	return true;
+}
+
+} /* End namespace ODBII */
+} /* End namespace Can */
+} /* End namespace VehicleInterfacePlugin */
@@ -0,0 +1,172 @@
+/*
+ * ODBIIScheduler.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef WORKERS_ODBIISCHEDULER_HPP_
+#define WORKERS_ODBIISCHEDULER_HPP_
+
+#include "CanDecoder.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace VehicleInterfacePlugin {
+namespace Can {
+namespace ODBII {
+
+/**
+ * Central scheduler for all the ODB-II PID requests on one bus.
+ *
+ * Mode 01 PIDs that are due at the same time are batched, up to six in a
+ * single request, with the fastest PIDs always served first.  Several
+ * requests may be outstanding at once, and each one is abandoned after a
+ * timeout so a missed response does not stall the PIDs it carried.
+ *
+ * Responses, including ISO-TP multi-frame responses to batched requests,
+ * are split with a precompiled table of the PID lengths and decoded straight
+ * into the vehicle state.
+ */
+class ODBIIScheduler {
+public:
+	typedef std::chrono::steady_clock clock_type;
+
+	/**
+	 * Function to send a raw CAN frame
+	 */
+	typedef std::function<bool(uint32_t id, const uint8_t *data, size_t len)> transmit_function;
+
+	/**
+	 * Identifies one registration of a PID, so a definition can be removed
+	 * without affecting any other definition of the same PID
+	 */
+	typedef uint64_t handle_type;
+
+	static constexpr size_t MaxPidsPerRequest = 6;
+	static constexpr size_t MaxInFlight = 2;
+	static constexpr size_t MaxResponse = 64;
+
+	ODBIIScheduler();
+
+	/**
+	 * Schedule a PID.  A PID that is added more than once is requested at the
+	 * shortest period, and each response is decoded for every registration.
+	 *
+	 * @param svcPid The service and PID, as used for the ODB-II definition id, e.g. 0x010D
+	 * @param period How often to request the PID
+	 * @param decoder The decoder for the PID value bytes, which is copied
+	 * @return The handle to remove this registration with
+	 */
+	handle_type Add(uint32_t svcPid, std::chrono::milliseconds period, const CanDecoder &decoder);
+
+	/**
+	 * Remove one registration, and stop requesting the PID once it has none
+	 */
+	void Remove(handle_type handle);
+
+	bool empty();
+
+	void set_Transmit(transmit_function transmit);
+	void set_Timeout(std::chrono::milliseconds timeout);
+
+	/**
+	 * Expire the old requests and send the PIDs that are due
+	 *
+	 * @return The next time to poll
+	 */
+	clock_type::time_point Poll(clock_type::time_point now);
+
+	/**
+	 * Handle a frame received from the bus
+	 *
+	 * @param time The receive time in microseconds since the epoch
+	 * @return True if the frame was an ODB-II response
+	 */
+	bool Received(uint32_t id, const uint8_t *data, size_t len, uint64_t time);
+
+	uint64_t get_Requests() const { return _requests; }
+	uint64_t get_Responses() const { return _responses; }
+	uint64_t get_Timeouts() const { return _timeouts; }
+
+	/**
+	 * @return The number of data bytes of the mode 01 PID, or zero if not known
+	 */
+	static uint8_t PidLength(uint8_t pid);
+
+private:
+	struct Registration {
+		handle_type handle;
+		std::chrono::milliseconds period;
+		CanDecoder decoder;
+	};
+
+	struct Pid {
+		uint8_t service;
+		uint16_t pid;
+		uint8_t length;
+
+		// The shortest period of the registrations
+		std::chrono::milliseconds period;
+		clock_type::time_point nextDue;
+		bool inFlight;
+		std::vector<Registration> users;
+	};
+
+	struct Pending {
+		uint8_t service;
+		uint8_t count;
+		uint16_t pids[MaxPidsPerRequest];
+		clock_type::time_point deadline;
+	};
+
+	// ISO-TP reassembly of a response from one ECU
+	struct Reassembly {
+		bool active;
+		uint8_t nextSeq;
+		size_t expected;
+		size_t received;
+		uint8_t data[MaxResponse];
+	};
+
+	std::mutex _lock;
+	transmit_function _transmit;
+	std::chrono::milliseconds _timeout;
+
+	// Sorted by period, so the fastest PIDs are sent first
+	std::vector<Pid> _pids;
+	handle_type _lastHandle;
+
+	// Index into the PIDs for each mode 01 PID, or -1
+	int16_t _mode1[256];
+
+	Pending _inFlight[MaxInFlight];
+	size_t _inFlightCount;
+
+	// For the ECU responses to 0x7E8 through 0x7EF
+	Reassembly _ecus[8];
+
+	std::atomic<uint64_t> _requests { 0 };
+	std::atomic<uint64_t> _responses { 0 };
+	std::atomic<uint64_t> _timeouts { 0 };
+
+	static void Split(uint32_t svcPid, uint8_t &service, uint16_t &pid);
+
+	void Sort();
+	void Reindex();
+	Pid *Find(uint8_t service, uint16_t pid);
+	void Send(Pending &request);
+	void Complete(uint8_t service, uint16_t pid);
+	void Release(Pending &request);
+	void Decode(Pid &p, const uint8_t *data, size_t len, uint64_t time);
+	void HandleResponse(const uint8_t *data, size_t len, uint64_t time);
+};
+
+} /* End namespace ODBII */
+} /* End namespace Can */
+} /* End namespace VehicleInterfacePlugin */
+
+#endif /* WORKERS_ODBIISCHEDULER_HPP_ */
@@ -6,17 +6,34 @@
  */
 
 #include "../workers/SocketCanInterface.hpp"
+#include "../workers/CanDecodePool.hpp"
 
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <mutex>
+#include <thread>
 
 #include <PluginLog.h>
 #include <tmx/TmxException.hpp>
 
+#include <pthread.h>
+#include <sched.h>
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <sys/ioctl.h>
+#include <sys/time.h>
 #include <net/if.h>
+#include <linux/can/error.h>
 #include <linux/can/raw.h>
+#include <linux/net_tstamp.h>
+
+// Number of frames to receive with one call
+#define RECV_BATCH 32
+
+// Room for a SO_TIMESTAMPING or SO_TIMESTAMP control message, and a SO_RXQ_OVFL count
+#define CONTROL_SIZE (CMSG_SPACE(3 * sizeof(struct timespec)) + CMSG_SPACE(sizeof(struct timeval)) + \
+		CMSG_SPACE(sizeof(uint32_t)))
 
 using namespace std;
 using namespace tmx;
@@ -27,11 +44,32 @@ using namespace VehicleInterfacePlugin;
 namespace VehicleInterfacePlugin {
 namespace Can {
 
-// Create and register an allocator for the socket CAN interface
-static VehicleConnection::TaskAllocatorImpl<SocketCanInterface> _socketCanAllocator;
+// Create and register an allocator for the socket CAN interface, with one worker per bus
+static VehicleConnection::GroupedTaskAllocatorImpl<SocketCanInterface> _socketCanAllocator;
 
-SocketCanInterface::SocketCanInterface(const message &config): _socket(0), _canData(config.get_container())
+// The next core for a reader pinned automatically
+static atomic<unsigned int> _nextCpu { 0 };
+
+SocketCanInterface::SocketCanInterface(const message &config): _socket(0), _table(new Table())
 {
+	_bus = GroupKey(config);
+	_hwTimestamps = (config.get_untyped("timestamp", "software") == "hardware");
+	_stats = CanBusStatistics::ForBus(_bus);
+
+	string cpu = config.get_untyped("cpu", "");
+	if (cpu == "auto")
+		_cpu = _nextCpu++ % max(1u, thread::hardware_concurrency());
+	else
+		_cpu = cpu.empty() ? -1 : strtol(cpu.c_str(), NULL, 0);
+
+	string decoders = config.get_untyped("decoders", "0");
+	_decoders = (decoders == "auto") ? -1 : strtol(decoders.c_str(), NULL, 0);
+
+	uint32_t bitRate = strtoul(config.get_untyped("bitrate", "500000").c_str(), NULL, 0);
+	if (bitRate > 0)
+		_stats->bitRate = bitRate;
+
+	AddRequest(config);
 }
 
 SocketCanInterface::~SocketCanInterface()
@@ -40,6 +78,32 @@ SocketCanInterface::~SocketCanInterface()
 		::close(this->_socket);
 }
 
+string SocketCanInterface::GroupKey(const message &config)
+{
+	return config.get_untyped("bus", "can0");
+}
+
+void SocketCanInterface::AddRequest(const message &config)
+{
+	shared_ptr<Table> table(new Table(*atomic_load(&_table)));
+	table->Add(config);
+	atomic_store(&_table, shared_ptr<const Table>(table));
+}
+
+void SocketCanInterface::Reconfigure(const vector<message> &configs)
+{
+	shared_ptr<Table> table(new Table());
+	for (auto &config : configs)
+		table->Add(config);
+
+	shared_ptr<const Table> old = atomic_exchange(&_table, shared_ptr<const Table>(table));
+
+	if (!old || !old->SameFilters(*table))
+		_refilter = true;
+
+	PLOG(logINFO) << _bus << ": Reconfigured with " << table->requests.size() << " CAN ids";
+}
+
 int SocketCanInterface::InitializeSocketCan(const char* ifname)
 {
 	int receiveOwnMessages = 0;
@@ -65,6 +129,7 @@ int SocketCanInterface::InitializeSocketCan(const char* ifname)
 	if(ioctl(sock, SIOCGIFINDEX, &ifr) < 0)
 	{
 		PLOG(logERROR) << "Could not find interface index.";
+		::close(sock);
 		return -1;
 	}
 	else
@@ -78,6 +143,7 @@ int SocketCanInterface::InitializeSocketCan(const char* ifname)
 	if(bind(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0)
 	{
 		PLOG(logERROR) << "Error binding the socket.";
+		::close(sock);
 		return -1;
 	}
 	else
@@ -86,35 +152,223 @@ int SocketCanInterface::InitializeSocketCan(const char* ifname)
 	}
 
 	setsockopt(sock, SOL_CAN_RAW, CAN_RAW_RECV_OWN_MSGS, &receiveOwnMessages, sizeof(receiveOwnMessages));
+
+	// Classic frames are still received as before with CAN FD enabled
+	int enableFd = 1;
+	if (setsockopt(sock, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &enableFd, sizeof(enableFd)) < 0)
+		PLOG(logDEBUG) << "CAN FD frames are not supported on " << ifname;
+
+	EnableTimestamps(sock);
+
+	// Receive the error frames as well, so the controller state is known
+	can_err_mask_t errMask = CAN_ERR_MASK;
+	if (setsockopt(sock, SOL_CAN_RAW, CAN_RAW_ERR_FILTER, &errMask, sizeof(errMask)) < 0)
+		PLOG(logWARNING) << _bus << ": Unable to receive CAN error frames: " << strerror(errno);
+
+	// Count the frames the kernel drops because the socket queue is full
+	int enableOverflow = 1;
+	if (setsockopt(sock, SOL_SOCKET, SO_RXQ_OVFL, &enableOverflow, sizeof(enableOverflow)) < 0)
+		PLOG(logDEBUG) << _bus << ": Socket queue overflows are not counted";
+	_kernelDrops = 0;
+
+	// Wake up periodically so the thread can be stopped on a quiet bus
+	struct timeval tv;
+	tv.tv_sec = 0;
+	tv.tv_usec = 200000;
+	setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
 	PLOG(logDEBUG) << "Socket configured to capture CAN Bus data.";
 
 	return sock;
 }
 
+/**
+ * Install one kernel filter for each requested id, so only the frames of
+ * interest are ever copied to the socket
+ */
+void SocketCanInterface::InstallFilters(const Table &table)
+{
+	vector<struct can_filter> filters;
+	for (auto &req : table.requests)
+	{
+		struct can_filter filter;
+		filter.can_id = req.key;
+		filter.can_mask = req.mask;
+		filters.push_back(filter);
+	}
+
+	if (filters.size() > CAN_RAW_FILTER_MAX)
+	{
+		// Too many for the kernel, so receive everything and let the table sort it out
+		PLOG(logWARNING) << _bus << ": " << filters.size() << " CAN ids is more than the kernel filter limit";
+
+		filters.resize(1);
+		filters[0].can_id = 0;
+		filters[0].can_mask = 0;
+	}
+
+	if (setsockopt(this->_socket, SOL_CAN_RAW, CAN_RAW_FILTER, filters.data(), filters.size() * sizeof(struct can_filter)) < 0)
+		PLOG(logERROR) << _bus << ": Unable to install CAN filters: " << strerror(errno);
+}
+
+void SocketCanInterface::EnableTimestamps(int sock)
+{
+	int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+	if (_hwTimestamps)
+		flags |= SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+
+	if (setsockopt(sock, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) == 0)
+		return;
+
+	// Older kernels only have the microsecond software time stamp
+	int enable = 1;
+	if (setsockopt(sock, SOL_SOCKET, SO_TIMESTAMP, &enable, sizeof(enable)) < 0)
+		PLOG(logWARNING) << _bus << ": No receive time stamps, using the decode time instead";
+}
+
+/**
+ * Read the control messages of a received frame.  The count of frames the
+ * kernel dropped from the socket queue is added to the bus statistics.
+ *
+ * @return The receive time of the frame in microseconds since the epoch,
+ * or zero if the kernel did not stamp it
+ */
+uint64_t SocketCanInterface::ReadControl(struct msghdr &hdr)
+{
+	uint64_t time = 0;
+
+	for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&hdr); cmsg != NULL; cmsg = CMSG_NXTHDR(&hdr, cmsg))
+	{
+		if (cmsg->cmsg_level != SOL_SOCKET)
+			continue;
+
+		if (cmsg->cmsg_type == SO_RXQ_OVFL)
+		{
+			// The total dropped since the socket was opened
+			uint32_t drops;
+			memcpy(&drops, CMSG_DATA(cmsg), sizeof(drops));
+			if (drops != _kernelDrops)
+			{
+				_stats->overflows += (uint32_t)(drops - _kernelDrops);
+				_kernelDrops = drops;
+			}
+		}
+		else if (time)
+		{
+			continue;
+		}
+		else if (cmsg->cmsg_type == SCM_TIMESTAMPING)
+		{
+			// The software time stamp is first and the raw hardware time stamp is last
+			struct timespec ts[3];
+			memcpy(ts, CMSG_DATA(cmsg), sizeof(ts));
+
+			struct timespec *t = &ts[0];
+			if (_hwTimestamps && (ts[2].tv_sec || ts[2].tv_nsec))
+				t = &ts[2];
+
+			if (t->tv_sec || t->tv_nsec)
+				time = (uint64_t)t->tv_sec * 1000000 + t->tv_nsec / 1000;
+		}
+		else if (cmsg->cmsg_type == SCM_TIMESTAMP)
+		{
+			struct timeval tv;
+			memcpy(&tv, CMSG_DATA(cmsg), sizeof(tv));
+			time = (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+		}
+	}
+
+	return time;
+}
+
+/**
+ * Track the controller state from an error frame
+ */
+void SocketCanInterface::HandleError(const struct canfd_frame &frame)
+{
+	canid_t err = frame.can_id & CAN_ERR_MASK;
+
+	PLOG(logDEBUG2) << _bus << ": Error frame " << std::hex << err << " " << std::hex << (int)frame.data[1];
+
+	_stats->errors++;
+
+	if (err & CAN_ERR_BUSOFF)
+		_stats->set_State(CanBusStatistics::BusOff);
+	else if (err & CAN_ERR_RESTARTED)
+		_stats->set_State(CanBusStatistics::Active);
+
+	if (err & CAN_ERR_CRTL)
+	{
+		uint8_t ctrl = frame.data[1];
+
+		if (ctrl & (CAN_ERR_CRTL_RX_OVERFLOW | CAN_ERR_CRTL_TX_OVERFLOW))
+			_stats->overflows++;
+
+		if (ctrl & (CAN_ERR_CRTL_RX_PASSIVE | CAN_ERR_CRTL_TX_PASSIVE))
+			_stats->set_State(CanBusStatistics::Passive);
+		else if (ctrl & (CAN_ERR_CRTL_RX_WARNING | CAN_ERR_CRTL_TX_WARNING))
+			_stats->set_State(CanBusStatistics::Warning);
+#ifdef CAN_ERR_CRTL_ACTIVE
+		else if (ctrl & CAN_ERR_CRTL_ACTIVE)
+			_stats->set_State(CanBusStatistics::Active);
+#endif
+	}
+}
+
+void SocketCanInterface::PinThread()
+{
+	if (_cpu < 0)
+		return;
+
+	cpu_set_t cpus;
+	CPU_ZERO(&cpus);
+	CPU_SET(_cpu, &cpus);
+
+	int err = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+	if (err)
+		PLOG(logWARNING) << _bus << ": Unable to pin the reader to core " << _cpu << ": " << strerror(err);
+	else
+		PLOG(logDEBUG) << _bus << ": Reader pinned to core " << _cpu;
+}
+
 void SocketCanInterface::DoWork()
 {
 	int threadId = VehicleConnection::GetConnection()->this_thread();
 
-	string bus = _canData.get_untyped("bus", "can0");
+	PinThread();
 
-	while (!_canData.is_empty() && IsRunning())
+	// Hand the frames to the decode pool, one batch per lane
+	CanDecodePool &pool = CanDecodePool::GetPool();
+	size_t lanes = 0;
+	vector<CanDecodePool::Batch> batches;
+
+	if (_decoders != 0)
 	{
-		struct can_frame frm;
-		struct sockaddr_can addr;
-		struct can_filter filter;
+		lanes = pool.Acquire(_decoders < 0 ? 0 : _decoders);
+		batches.resize(lanes);
+	}
 
-		socklen_t len;
+	// A CAN FD frame has the same layout as a classic frame, with more data
+	struct canfd_frame frames[RECV_BATCH];
+	char control[RECV_BATCH][CONTROL_SIZE];
+	struct iovec iov[RECV_BATCH];
+	struct mmsghdr msgs[RECV_BATCH];
 
-		memset(frm.data, 0, 8);
+	while (IsRunning())
+	{
+		// Hold the current table for the whole batch
+		shared_ptr<const Table> table = atomic_load(&_table);
 
-		if (this->_socket <= 0)
+		// Nothing enabled on this bus, so just wait to be stopped
+		if (table->requests.empty())
 		{
-			// TODO: Obtain the request information for this thread
-
-			filter.can_id = strtol(_canData.get_id().c_str(), NULL, 0);
-			filter.can_mask = MaskByName(_canData.get_mask());
+			this_thread::sleep_for(std::chrono::milliseconds(200));
+			continue;
+		}
 
-			this->_socket = InitializeSocketCan(bus.c_str());
+		if (this->_socket <= 0)
+		{
+			this->_socket = InitializeSocketCan(_bus.c_str());
 
 			if (this->_socket <= 0)
 			{
@@ -124,38 +378,113 @@ void SocketCanInterface::DoWork()
 				break;
 			}
 
-			setsockopt(this->_socket, SOL_CAN_RAW, CAN_RAW_FILTER, &filter, sizeof(filter));
+			InstallFilters(*table);
+			_refilter = false;
 
 			PLOG(logINFO) << "Thread " << threadId << " (" << this_thread::get_id() << ") for monitoring " <<
-					(_canData.get_comment().empty() ? _canData.get_name() : _canData.get_comment()) << " has been started.";
+					table->requests.size() << " CAN ids on " << _bus << " has been started.";
+		}
+		else if (_refilter.exchange(false))
+		{
+			InstallFilters(*table);
+		}
+
+		for (int i = 0; i < RECV_BATCH; i++)
+		{
+			iov[i].iov_base = &frames[i];
+			iov[i].iov_len = sizeof(struct canfd_frame);
+			memset(&msgs[i], 0, sizeof(msgs[i]));
+			msgs[i].msg_hdr.msg_iov = &iov[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+			msgs[i].msg_hdr.msg_control = control[i];
+			msgs[i].msg_hdr.msg_controllen = CONTROL_SIZE;
 		}
 
-		int ret = recvfrom(this->_socket, &frm, sizeof(struct can_frame), 0, (struct sockaddr*)&addr, &len);
+		// Block for the first frame, then take whatever else is queued
+		int ret = recvmmsg(this->_socket, msgs, RECV_BATCH, MSG_WAITFORONE, NULL);
 
-		if(ret < 0)
+		if (ret < 0)
 		{
-			PLOG(logERROR) << _canData.get_name() << ": Problem receiving from " << bus << " socket";
+			if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+				continue;
+
+			PLOG(logERROR) << _bus << ": Problem receiving from socket: " << strerror(errno);
 
 			// Try again after a few milliseconds
+			::close(this->_socket);
+			this->_socket = 0;
 			this_thread::sleep_for(std::chrono::milliseconds(200));
-			return;
+			continue;
 		}
 
-		PLOG(logDEBUG2) << this_thread::get_id() << ": Received " << frm.can_id << " frame of " << (int)frm.can_dlc << " bytes.";
+		PLOG(logDEBUG3) << this_thread::get_id() << ": Received " << ret << " frames.";
 
-		// Make sure this is the correct set of bytes
-		/*if (frm.can_id != filter.can_id) {
-			PLOG(logDEBUG4) << _canData.get_name() << "Dropping mismatch CAN ID " << frm.can_id;
-			continue;
-		}*/
+		uint64_t received = 0;
+		uint64_t bits = 0;
 
-		byte_stream frameBytes{frm.data[0],frm.data[1],frm.data[2],frm.data[3],frm.data[4],frm.data[5],frm.data[6],frm.data[7]};
-		frameBytes.resize(frm.can_dlc);
+		for (int i = 0; i < ret; i++)
+		{
+			uint64_t time = ReadControl(msgs[i].msg_hdr);
+
+			if (frames[i].can_id & CAN_ERR_FLAG)
+			{
+				HandleError(frames[i]);
+				continue;
+			}
 
-		auto vbm = _canData.decode_VBM(frameBytes);
-		VehicleConnection::GetConnection()->BroadcastMessage(vbm);
+			size_t len = frames[i].len;
+			if (msgs[i].msg_len == CANFD_MTU)
+			{
+				_stats->fdFrames++;
+				len = min<size_t>(len, CANFD_MAX_DLEN);
+			}
+			else if (msgs[i].msg_len == CAN_MTU)
+			{
+				len = min<size_t>(len, CAN_MAX_DLEN);
+			}
+			else
+			{
+				// Not a CAN frame
+				continue;
+			}
+
+			received++;
+			bits += CanBusStatistics::FrameBits(frames[i].can_id & CAN_EFF_FLAG, len);
+
+			if (lanes == 0)
+			{
+				if (!table->Dispatch(frames[i].can_id, frames[i].data, len, time))
+					_stats->unmatched++;
+				continue;
+			}
+
+			CanDecodePool::Batch &batch = batches[CanDecodePool::LaneFor(frames[i].can_id, lanes)];
+			batch.frames.emplace_back();
+
+			CanDecodePool::Frame &frame = batch.frames.back();
+			frame.id = frames[i].can_id;
+			frame.len = len;
+			frame.time = time;
+			memcpy(frame.data, frames[i].data, len);
+		}
+
+		_stats->frames += received;
+		_stats->bits += bits;
+
+		for (size_t lane = 0; lane < lanes; lane++)
+		{
+			if (batches[lane].frames.empty())
+				continue;
+
+			batches[lane].table = table;
+			batches[lane].stats = _stats;
+			pool.Submit(lane, batches[lane]);
+		}
 	}
 
+	if (lanes > 0)
+		pool.Release();
+
 	PLOG(logINFO) << "Thread " << threadId << " (" << this_thread::get_id() << ") is exiting.";
 
 	this->_active = false;
@@ -10,10 +10,44 @@
 
 #include "../VehicleConnection.h"
 #include "../workers/CanData.hpp"
+#include "../workers/CanBusStatistics.hpp"
+#include "../workers/CanRequestTable.hpp"
+
+#include <atomic>
+#include <memory>
+#include <vector>
 
 namespace VehicleInterfacePlugin {
 namespace Can {
 
+/**
+ * Reader for all the requested CAN ids on one socketCAN bus.
+ *
+ * Every request for the same bus is added to a single worker, which opens one
+ * raw socket with the complete set of id filters installed in the kernel.
+ * Frames are received in batches and dispatched to the compiled decoder for
+ * their id through a sorted table.
+ *
+ * Both classic and CAN FD frames are accepted.  Each frame is stamped by the
+ * kernel when it is received, and that time is kept with the decoded values.
+ * The software receive time is used unless the bus is configured with
+ * "timestamp": "hardware" and the interface supplies a hardware time stamp.
+ *
+ * Error frames are received too, to track the state of the controller.  The
+ * state, the bus load for the configured "bitrate", and the frames lost to
+ * controller or socket queue overflows are kept with the bus statistics.
+ *
+ * The reader may be pinned to a core with "cpu", either a core number or
+ * "auto" to spread the readers over the cores.  The frames are decoded on
+ * the reader thread unless "decoders" is set, in which case they are handed
+ * to the decode threads shared by all the buses, either that many or "auto"
+ * for one per core not taken by a reader.
+ *
+ * The requests can be replaced while the worker runs.  The new dispatch
+ * table is swapped in atomically, the reader finishes its current batch
+ * with the old one, and the kernel filters are only reinstalled if the set
+ * of ids changed.
+ */
 class SocketCanInterface: public tmx::utils::ThreadWorker {
 public:
 	static constexpr const char *TaskName = "socketCAN";
@@ -21,6 +55,22 @@ public:
 	SocketCanInterface(const tmx::message &config);
 	virtual ~SocketCanInterface();
 
+	/**
+	 * @return The bus name, which groups the requests into one worker
+	 */
+	static std::string GroupKey(const tmx::message &config);
+
+	/**
+	 * Add another CAN id request on the same bus.  Must be called before the
+	 * worker is started.
+	 */
+	void AddRequest(const tmx::message &config);
+
+	/**
+	 * Replace all the requests on the bus without stopping the worker
+	 */
+	void Reconfigure(const std::vector<tmx::message> &configs);
+
 	/**
 	 * Initialize the socket to the given CAN interface
 	 */
@@ -31,9 +81,42 @@ public:
 	 */
 	void DoWork();
 
+	uint64_t get_Frames() const { return _stats->frames; }
+	uint64_t get_FdFrames() const { return _stats->fdFrames; }
+	uint64_t get_Unmatched() const { return _stats->unmatched; }
+	uint64_t get_Dropped() const { return _stats->dropped; }
+
 private:
+	typedef CanRequestTable Table;
+
 	int _socket;
-	CanDataAdaptor _canData;
+	std::string _bus;
+
+	// Prefer the raw hardware time stamps to the software ones
+	bool _hwTimestamps;
+
+	// The core for the reader thread, or -1 for any
+	int _cpu;
+
+	// Decode on the reader thread, or the number of pool threads, or -1 for one per core
+	int _decoders;
+
+	// Only accessed through the atomic shared_ptr functions
+	std::shared_ptr<const Table> _table;
+
+	// Set when the kernel filters must be reinstalled by the reader
+	std::atomic<bool> _refilter { false };
+
+	std::shared_ptr<CanBusStatistics> _stats;
+
+	// The kernel count of frames dropped from the socket queue
+	uint32_t _kernelDrops = 0;
+
+	void PinThread();
+	void InstallFilters(const Table &table);
+	void EnableTimestamps(int sock);
+	uint64_t ReadControl(struct msghdr &hdr);
+	void HandleError(const struct canfd_frame &frame);
 };
 
 } /* End namespace Can */
@@ -0,0 +1,83 @@
+/*
+ * SpscRing.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef WORKERS_SPSCRING_HPP_
+#define WORKERS_SPSCRING_HPP_
+
+#include <atomic>
+#include <cstddef>
+
+namespace VehicleInterfacePlugin {
+
+/**
+ * Fixed size ring of values between exactly one producer thread and one
+ * consumer thread.
+ *
+ * All the slots are allocated with the ring, so neither side ever allocates,
+ * locks or blocks.  The producer fails to push when the ring is full.
+ *
+ * @param T The value type, which is copied in and out of the slots
+ * @param N The number of slots, which must be a power of two
+ */
+template <typename T, size_t N>
+class SpscRing {
+	static_assert(N > 0 && (N & (N - 1)) == 0, "Ring size must be a power of two");
+
+public:
+	/**
+	 * Copy the value into the next free slot.  Only called by the producer.
+	 *
+	 * @return False if the ring is full
+	 */
+	bool push(const T &value)
+	{
+		size_t tail = _tail.load(std::memory_order_relaxed);
+		if (tail - _head.load(std::memory_order_acquire) >= N)
+			return false;
+
+		_slots[tail & (N - 1)] = value;
+		_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * Copy the oldest value out of the ring.  Only called by the consumer.
+	 *
+	 * @return False if the ring is empty
+	 */
+	bool pop(T &value)
+	{
+		size_t head = _head.load(std::memory_order_relaxed);
+		if (head == _tail.load(std::memory_order_acquire))
+			return false;
+
+		value = _slots[head & (N - 1)];
+		_head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool empty() const
+	{
+		return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+	}
+
+	size_t size() const
+	{
+		return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire);
+	}
+
+	static constexpr size_t capacity() { return N; }
+
+private:
+	// Keep the two indexes on separate cache lines so the threads do not share one
+	alignas(64) std::atomic<size_t> _head { 0 };
+	alignas(64) std::atomic<size_t> _tail { 0 };
+	alignas(64) T _slots[N];
+};
+
+} /* End namespace VehicleInterfacePlugin */
+
+#endif /* WORKERS_SPSCRING_HPP_ */
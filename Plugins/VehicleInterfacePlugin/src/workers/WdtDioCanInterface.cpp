@@ -8,14 +8,24 @@
 #include "WdtDioCanInterface.h"
 #include "CanData.hpp"
 
-#include "ODBIIMessage.hpp"
+#include "CanBusStatistics.hpp"
+#include "ODBIIScheduler.hpp"
 
-#include <LockFreeThread.h>
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
 #include <Measurement.h>
+#include <memory>
+#include <mutex>
 #include <thread>
 #include <tmx/messages/auto_message.hpp>
 #include <vector>
 
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
 using namespace std;
 using namespace tmx;
 using namespace tmx::messages;
@@ -26,167 +36,270 @@ namespace Can {
 
 static VehicleConnection::TaskAllocatorImpl<WdtDioCanInterface> _wdtDioAlloc;
 
-static constexpr const size_t ODBII_ADDR_LEN = sizeof(ODBII::ODBIIMessage::Address::data_type);
+/**
+ * Messages to send from all the workers to the transmit thread.  The slots
+ * are preallocated, and the transmit thread sleeps until a message arrives.
+ */
+class WdtDioTransmitQueue {
+public:
+	bool push(const CAN_MSG &canMsg)
+	{
+		{
+			lock_guard<mutex> lock(_lock);
+			if (!_ring.push(canMsg))
+				return false;
+		}
 
-ODBII::ODBIIMessage ToODB2Message(const CAN_MSG *canMsg)
-{
-	ODBII::ODBIIMessage msg;
+		_cv.notify_one();
+		return true;
+	}
 
-	if (canMsg)
+	/**
+	 * Wake up the transmit thread without a message, e.g. to poll the ODB-II scheduler
+	 */
+	void wake()
 	{
-		byte_stream bytes(canMsg->len + ODBII_ADDR_LEN);
-		memcpy(&bytes.data()[ODBII_ADDR_LEN], canMsg->data, canMsg->len);
+		{
+			lock_guard<mutex> lock(_lock);
+			_woken = true;
+		}
 
-		msg.decode(bytes);
-		msg.set_Address(canMsg->id);
+		_cv.notify_one();
 	}
 
-	return msg;
-}
-
-CAN_MSG *FromODB2Message(ODBII::ODBIIMessage &msg, CAN_MSG *canMsg)
-{
-	if (canMsg)
+	/**
+	 * Wait for the next message to send
+	 *
+	 * @return False if nothing was queued before the timeout or a wake up
+	 */
+	template <class Clock, class Duration>
+	bool pop(CAN_MSG &canMsg, const chrono::time_point<Clock, Duration> &until)
 	{
-		canMsg->id = msg.get_Address();
+		unique_lock<mutex> lock(_lock);
+		_cv.wait_until(lock, until, [this]() { return _woken || !_ring.empty(); });
 
-		byte_stream bytes = msg.encode();
-		canMsg->len = bytes.size() - ODBII_ADDR_LEN;
-		memcpy(canMsg->data, &bytes.data()[ODBII_ADDR_LEN], canMsg->len);
+		_woken = false;
+		return _ring.pop(canMsg);
 	}
 
-	return canMsg;
+private:
+	SpscRing<CAN_MSG, 64> _ring;
+	bool _woken = false;
+	mutex _lock;
+	condition_variable _cv;
+};
+
+static WdtDioTransmitQueue _txQueue;
+
+// All the ODB-II PIDs requested through the WDT_DIO driver
+static ODBII::ODBIIScheduler _odbScheduler;
+
+// The running workers, sorted by CAN id.  The list is replaced, never changed, when a worker starts or stops.
+static shared_ptr<const vector<WdtDioCanInterface *> > _registry { new vector<WdtDioCanInterface *>() };
+
+// Number of driver callbacks that may still be using an old list
+static atomic<int> _callbacks { 0 };
+
+// For changes to the list and the driver thread
+static mutex _registryLock;
+static ThreadWorker *_mgrThread = NULL;
+static size_t _mgrUsers = 0;
+
+// The counters for the bus while the driver is connected.  Only accessed through the atomic shared_ptr functions.
+static shared_ptr<CanBusStatistics> _busStats;
+
+static bool CompareCanId(WdtDioCanInterface *a, WdtDioCanInterface *b)
+{
+	return a->CanId() < b->CanId();
 }
 
-WdtDioCanInterface::WdtDioCanInterface(const message &config): _canData(config.get_container())
+WdtDioCanInterface::WdtDioCanInterface(const message &config): _canData(config.get_container()), _decoder(_canData)
 {
 	Measurement<units::Time, units::Time::ms> msFreq = _canData.get_untyped("frequency", "500 ms");
 
-	if (msFreq > 0)
-		_throttle.set_Frequency(std::chrono::milliseconds(static_cast<int64_t>(msFreq.get_value())));
-
 	myId = strtol(_canData.get_id().c_str(), NULL, 0);
+
+	_decoder.Bind(VehicleState::GetState());
+
+	// The requests and responses are all handled by the scheduler
+	if (_canData.get_enabled() && _canData.get_type() == ODB_TYPE::ODBII)
+		_odbHandle = _odbScheduler.Add(myId, chrono::milliseconds(msFreq > 0 ? static_cast<int64_t>(msFreq.get_value()) : 500), _decoder);
+
+	// Only a worker with a thread is woken up
+	if (!_odbHandle)
+	{
+		_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (_wakeFd < 0)
+			PLOG(logERROR) << "Unable to create event for " << _canData.get_name() << ": " << strerror(errno);
+	}
 }
 
 WdtDioCanInterface::~WdtDioCanInterface()
 {
+	Stop();
+
+	if (_odbHandle)
+		_odbScheduler.Remove(_odbHandle);
+
+	if (_wakeFd >= 0)
+		::close(_wakeFd);
 }
 
-void WdtDioCanInterface::doWork(std::shared_ptr<CAN_MSG> &canMsg)
+void WdtDioCanInterface::doWork(const WdtDioCanFrame &frame)
 {
 	PLOG(logDEBUG4) << Id() << ": In doWork";
 
-	if (!canMsg) return;
+	_decoder.Update(frame.msg.data, frame.msg.len, frame.time);
+}
 
-	VehicleBasicMessage vbm;
+void WdtDioCanInterface::DoWork()
+{
+	WdtDioCanFrame frame;
 
-	if (_canData.get_type() == ODB_TYPE::ODBII)
+	while (this->IsRunning())
 	{
-		ODBII::ODBIIMessage odb2 = ToODB2Message(canMsg.get());
-
-		PLOG(logDEBUG) << Id() << ": Received ODBII response: " << odb2;
+		// Drain everything queued since the last wake up
+		while (_rxRing.pop(frame))
+		{
+			if (accept(frame.msg))
+				doWork(frame);
+		}
 
-		vbm = _canData.decode_VBM(odb2.get_Value_bytes());
+		idle();
 	}
-	else
+}
+
+void WdtDioCanInterface::Received(const CAN_MSG &canMsg, uint64_t time)
+{
+	WdtDioCanFrame frame;
+	frame.msg = canMsg;
+	frame.time = time;
+
+	if (!_rxRing.push(frame))
 	{
-		byte_stream bytes(canMsg->len);
-		memcpy(bytes.data(), canMsg->data, canMsg->len);
+		_dropped++;
 
-		vbm = _canData.decode_VBM(bytes);
+		auto stats = atomic_load(&_busStats);
+		if (stats)
+			stats->dropped++;
+		return;
 	}
 
-	VehicleConnection::GetConnection()->BroadcastMessage(vbm);
+	// Pairs with the fence in Sleep, so either the worker sees the frame or the callback sees it asleep
+	atomic_thread_fence(memory_order_seq_cst);
+
+	if (_sleeping.load(memory_order_relaxed) && _sleeping.exchange(false) && _wakeFd >= 0)
+	{
+		uint64_t one = 1;
+		if (::write(_wakeFd, &one, sizeof(one)) < 0)
+			PLOG(logDEBUG) << "Unable to wake " << _canData.get_name() << ": " << strerror(errno);
+	}
 }
 
-void WdtDioCanInterface::idle()
+void WdtDioCanInterface::Sleep(int timeoutMs)
 {
-	PLOG(logDEBUG4) << Id() << ": In idle";
+	_sleeping = true;
+	atomic_thread_fence(memory_order_seq_cst);
 
-	// Handle ODB-II requests
-	if (_canData.get_enabled() && _canData.get_type() == ODB_TYPE::ODBII && _throttle.Monitor(0))
+	if (_rxRing.empty() && _wakeFd >= 0)
 	{
-		ODBII::ODBIIMessage odb2;
-		odb2.set_Request(CanId());
-
-		PLOG(logDEBUG2) << Id() << ": Sending ODBII request message: " << odb2;
-
-		CAN_MSG *canMsg = (CAN_MSG *)malloc(sizeof(CAN_MSG));
-		FromODB2Message(odb2, canMsg);
-
-		this->push_out(std::shared_ptr<CAN_MSG> { canMsg, [](CAN_MSG *p){ free(p); } });
+		struct pollfd pfd;
+		pfd.fd = _wakeFd;
+		pfd.events = POLLIN;
+		::poll(&pfd, 1, timeoutMs);
+
+		uint64_t count;
+		if (::read(_wakeFd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+			PLOG(logDEBUG) << "Unable to clear wake up for " << _canData.get_name() << ": " << strerror(errno);
+	}
+	else if (_wakeFd < 0)
+	{
+		this_thread::sleep_for(chrono::milliseconds(1));
 	}
 
+	_sleeping = false;
+}
+
+void WdtDioCanInterface::idle()
+{
 	PLOG(logDEBUG4) << Id() << ": Waiting for next CAN message";
 
-	unique_lock<mutex> lock(_lock);
-	this->_cv.wait(lock, bind(&WdtDioCanInterface::inQueueSize, this));
+	// Wake up periodically to stop
+	Sleep(50);
 }
 
-bool WdtDioCanInterface::accept(const std::shared_ptr<CAN_MSG> &canMsg)
+bool WdtDioCanInterface::accept(const CAN_MSG &canMsg)
 {
 	PLOG(logDEBUG4) << this_thread::get_id() << ": In accept";
 
-	if (!canMsg || !_canData.get_enabled())
+	// ODB-II responses go to the scheduler instead
+	if (!_canData.get_enabled() || _canData.get_type() == ODB_TYPE::ODBII)
 		return false;
 
 	// Only process this message if it was destined for this thread
-	if (_canData.get_type() == ODB_TYPE::ODBII)
-	{
-		ODBII::ODBIIMessage odb2;
-		odb2.set_Request(CanId());
+	return (CanId() == canMsg.id);
+}
 
-		ODBII::ODBIIMessage msg = ToODB2Message(canMsg.get());
 
-		PLOG(logDEBUG2) << "Comparing receieved ODB-II message: " << msg << " to request: " << odb2;
+void __stdcall WdtDioCanReceived(CAN_MSG *IpMsg, DWORD cbMsg)
+{
+	PLOG(logDEBUG4) << this_thread::get_id() << ": In WdtDioCanReceived.";
+
+	if (!IpMsg) return;
+
+	PLOG(logDEBUG3) << "Received " << IpMsg->id;
 
-		// Can only compare a request message to a request message since service numbers are encoded different
-		ODBII::ODBIIMessage odb2resp;
-		odb2resp.set_Request(msg);
+	uint64_t now = VehicleState::Now();
 
-		return (odb2.get_Service() == odb2resp.get_Service() && odb2.get_PID() == odb2resp.get_PID());
+	auto stats = atomic_load(&_busStats);
+	if (stats)
+	{
+		stats->frames++;
+		stats->bits += CanBusStatistics::FrameBits(IpMsg->flags & CAN_MSG_EXTENDED_ID, IpMsg->len);
+
+		// The controller overwrote a frame that was not read in time
+		if (IpMsg->flags & CAN_MSG_DATA_LOST)
+			stats->overflows++;
 	}
-	else
+
+	// Let the transmit thread send any flow control, or the next request now there is room
+	if (_odbScheduler.Received(IpMsg->id, IpMsg->data, IpMsg->len, now))
 	{
-		return (CanId() == canMsg->id);
+		_txQueue.wake();
+		return;
 	}
-}
 
-void WdtDioCanInterface::notify() {
-	this->_cv.notify_all();
-}
+	_callbacks++;
 
-WdtDioCanInterface *WdtDioFindThread(DWORD id)
-{
-	auto conn = VehicleConnection::GetConnection();
-	if (!conn)
-		return NULL;
-
-	static ThreadGroupAssignment<uint8_t, uint8_t> _tga { *conn };
-	int thread = _tga.assign((id >> 8) & 0xFF, id & 0xFF);
-	if (thread < 0)
-		return NULL;
-	else
-		return dynamic_cast<WdtDioCanInterface *>((*conn)[thread]);
+	// Every worker for the id gets a copy
+	auto workers = atomic_load(&_registry);
+	auto iter = lower_bound(workers->begin(), workers->end(), IpMsg->id,
+			[](WdtDioCanInterface *w, DWORD id) { return w->CanId() < id; });
+	for (; iter != workers->end() && (*iter)->CanId() == IpMsg->id; iter++)
+		(*iter)->Received(*IpMsg, now);
+
+	_callbacks--;
 }
 
-void __stdcall WdtDioCanReceived(CAN_MSG *IpMsg, DWORD cbMsg)
+void __stdcall WdtDioCanStatus(DWORD status)
 {
-	PLOG(logDEBUG4) << this_thread::get_id() << ": In WdtDioCanReceived.";
+	PLOG(logDEBUG2) << "WDT_DIO CAN status " << std::hex << status;
 
-	if (!IpMsg) return;
+	auto stats = atomic_load(&_busStats);
+	if (!stats)
+		return;
 
-	PLOG(logDEBUG3) << "Received " << IpMsg->id;
+	if (status & CAN_STATUS_LEC_MASK)
+		stats->errors++;
 
-	WdtDioCanInterface *canThread = WdtDioFindThread(IpMsg->id);
-	if (canThread) {
-		CAN_MSG *copy = (CAN_MSG *) malloc(sizeof(CAN_MSG));
-		if (copy) {
-			*copy = *IpMsg;
-			canThread->push(shared_ptr<CAN_MSG> { copy, [](CAN_MSG *p) { if (p) free(p); p = NULL; } });
-			canThread->notify();
-		}
-	}
+	if (status & CAN_STATUS_BUS_OFF)
+		stats->set_State(CanBusStatistics::BusOff);
+	else if (status & CAN_STATUS_EPASS)
+		stats->set_State(CanBusStatistics::Passive);
+	else if (status & CAN_STATUS_EWARN)
+		stats->set_State(CanBusStatistics::Warning);
+	else
+		stats->set_State(CanBusStatistics::Active);
 }
 
 class WdtDioTxRxThread: public ThreadWorker {
@@ -197,17 +310,6 @@ public:
 	{
 		PLOG(logINFO) << "WdtDioRxThread (" << this_thread::get_id() << ") is starting.";
 
-		auto conn = VehicleConnection::GetConnection();
-
-		// Pre-assign all the threads in the group so the IDs are automatically
-		// matched when received
-		for (size_t i = 0; conn && i < conn->size(); i++)
-		{
-			WdtDioCanInterface *canThread = dynamic_cast<WdtDioCanInterface *>((*conn)[i]);
-			if (canThread)
-				WdtDioFindThread(canThread->CanId());
-		}
-
 		// Open a connection to the CAN through the WDT_DIO driver
 		if (!CAN_RegisterReceived(0, &WdtDioCanReceived))
 		{
@@ -215,6 +317,10 @@ public:
 			BOOST_THROW_EXCEPTION(regFailed);
 		}
 
+		// Not fatal, since the frames can still be received
+		if (!CAN_RegisterStatus(0, &WdtDioCanStatus))
+			PLOG(logWARNING) << "Unable to register for the WDT_DIO CAN status";
+
 
 		if (!CAN_Setup(0, &setup, sizeof(setup)))
 		{
@@ -228,26 +334,32 @@ public:
 			BOOST_THROW_EXCEPTION(startFailed);
 		}
 
+		_odbScheduler.set_Transmit([](uint32_t id, const uint8_t *data, size_t len) {
+			CAN_MSG canMsg;
+			memset(&canMsg, 0, sizeof(canMsg));
+			canMsg.id = id;
+			canMsg.len = min<size_t>(len, sizeof(canMsg.data));
+			memcpy(canMsg.data, data, canMsg.len);
+			return _txQueue.push(canMsg);
+		});
+
 		while (this->IsRunning())
 		{
-			// Await next CAN messages to send
-			shared_ptr<CAN_MSG> canMsg;
-			for (size_t i = 0; conn && i < conn->size(); i++)
+			// Queue the ODB-II requests that are due
+			auto next = _odbScheduler.Poll(ODBII::ODBIIScheduler::clock_type::now());
+
+			// Await next CAN messages to send, or the next ODB-II request
+			CAN_MSG canMsg;
+			if (_txQueue.pop(canMsg, next))
 			{
-				WdtDioCanInterface *ifc = dynamic_cast<WdtDioCanInterface *>(conn->operator[](i));
-				if (ifc && ifc->pop(canMsg))
+				if (!CAN_Send(0, &canMsg, sizeof(CAN_MSG)))
 				{
-					if (canMsg && !CAN_Send(0, canMsg.get(), sizeof(CAN_MSG)))
-					{
-						byte_stream bytes(canMsg->len);
-						memcpy(bytes.data(), canMsg->data, canMsg->len);
+					byte_stream bytes(canMsg.len);
+					memcpy(bytes.data(), canMsg.data, canMsg.len);
 
-						PLOG(logERROR) << "Unable to send CAN message " << bytes << " to " << canMsg->id;
-					}
+					PLOG(logERROR) << "Unable to send CAN message " << bytes << " to " << canMsg.id;
 				}
 			}
-
-			this_thread::sleep_for(chrono::milliseconds(5));
 		}
 
 		CAN_Stop(0);
@@ -262,26 +374,49 @@ DWORD WdtDioCanInterface::CanId() {
 
 void WdtDioCanInterface::Start()
 {
-	// Start up the thread
-	LockFreeThread::Start();
-	if (this->_thread)
+	if (_odbHandle)
 	{
-		auto tId = this->_thread->get_id();
-		int threadId = VehicleConnection::GetConnection()->this_thread(tId);
+		// The scheduler does all the work, so only the bus connection is needed
+		this->_active = true;
 
-		PLOG(logINFO) << "Thread " << threadId << " (" << tId << ") for monitoring " <<
-			(_canData.get_comment().empty() ? _canData.get_name() : _canData.get_comment()) << " has been started.";
+		PLOG(logINFO) << "ODB-II PID " << std::hex << myId << std::dec << " for monitoring " <<
+			(_canData.get_comment().empty() ? _canData.get_name() : _canData.get_comment()) << " has been scheduled.";
 	}
 	else
 	{
-		PLOG(logERROR) << "Unable to start thread for monitoring " <<
-				(_canData.get_comment().empty() ? _canData.get_name() : _canData.get_comment());
-		LockFreeThread::Stop();
-		return;
+		// Start up the thread
+		ThreadWorker::Start();
+		if (this->_thread)
+		{
+			auto tId = this->_thread->get_id();
+			int threadId = VehicleConnection::GetConnection()->this_thread(tId);
+
+			PLOG(logINFO) << "Thread " << threadId << " (" << tId << ") for monitoring " <<
+				(_canData.get_comment().empty() ? _canData.get_name() : _canData.get_comment()) << " has been started.";
+		}
+		else
+		{
+			PLOG(logERROR) << "Unable to start thread for monitoring " <<
+					(_canData.get_comment().empty() ? _canData.get_name() : _canData.get_comment());
+			ThreadWorker::Stop();
+			return;
+		}
+	}
+
+	lock_guard<mutex> lock(_registryLock);
+
+	// Start receiving frames for this id
+	if (!_odbHandle)
+	{
+		shared_ptr<vector<WdtDioCanInterface *> > workers(new vector<WdtDioCanInterface *>(*_registry));
+		workers->insert(upper_bound(workers->begin(), workers->end(), this, CompareCanId), this);
+		atomic_store(&_registry, shared_ptr<const vector<WdtDioCanInterface *> >(workers));
 	}
 
-	static std::atomic<bool> _startMgrThread { true };
-	if (_startMgrThread.exchange(false))
+	_registered = true;
+
+	// The first worker to start connects to the bus
+	if (_mgrUsers++ == 0)
 	{
 		auto wdtDioThread = new WdtDioTxRxThread();
 
@@ -293,18 +428,48 @@ void WdtDioCanInterface::Start()
 
 		PLOG(logDEBUG) << "Connecting to WDT_DIO CAN bus with " << data;
 
-		mgrThread = wdtDioThread;
-		mgrThread->Start();
+		shared_ptr<CanBusStatistics> stats = CanBusStatistics::ForBus("wdt_dio");
+		if (wdtDioThread->setup.bitRate > 0)
+			stats->bitRate = wdtDioThread->setup.bitRate;
+		atomic_store(&_busStats, stats);
+
+		_mgrThread = wdtDioThread;
+		_mgrThread->Start();
 	}
 }
 
 void WdtDioCanInterface::Stop() {
-	LockFreeThread::Stop();
+	ThreadWorker *mgrThread = NULL;
+
+	{
+		lock_guard<mutex> lock(_registryLock);
+
+		if (_registered)
+		{
+			shared_ptr<vector<WdtDioCanInterface *> > workers(new vector<WdtDioCanInterface *>(*_registry));
+			workers->erase(remove(workers->begin(), workers->end(), this), workers->end());
+			atomic_store(&_registry, shared_ptr<const vector<WdtDioCanInterface *> >(workers));
+			_registered = false;
+
+			// The last worker to stop disconnects from the bus
+			if (--_mgrUsers == 0)
+			{
+				mgrThread = _mgrThread;
+				_mgrThread = NULL;
+			}
+		}
+	}
+
+	// Wait out any callback still using the old list
+	while (_callbacks > 0)
+		this_thread::yield();
+
+	ThreadWorker::Stop();
 
 	if (mgrThread)
 	{
 		delete mgrThread;
-		mgrThread = NULL;
+		atomic_store(&_busStats, shared_ptr<CanBusStatistics>());
 	}
 }
 
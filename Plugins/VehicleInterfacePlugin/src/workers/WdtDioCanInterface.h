@@ -10,45 +10,86 @@
 
 #include "../VehicleConnection.h"
 
-#define USE_STD_CHRONO
+#include <atomic>
 #include <chrono>
-#include <condition_variable>
-#include <FrequencyThrottle.h>
-#include <LockFreeThread.h>
-#include <memory>
-#include <mutex>
 #include <tmx/messages/message.hpp>
 #include <wdt_dio.h>
 #include "../workers/CanData.hpp"
+#include "../workers/CanDecoder.hpp"
+#include "../workers/ODBIIScheduler.hpp"
+#include "../workers/SpscRing.hpp"
 
 namespace VehicleInterfacePlugin {
 namespace Can {
 
-class WdtDioCanInterface: public tmx::utils::LockFreeThread<std::shared_ptr<CAN_MSG> > {
+/**
+ * A received CAN message and the time it arrived, in microseconds since the epoch
+ */
+struct WdtDioCanFrame {
+	CAN_MSG msg;
+	uint64_t time;
+};
+
+/**
+ * Worker for one CAN id read through the WDT_DIO driver.
+ *
+ * The driver callback copies each frame into the ring of the worker for its
+ * id, and only signals the worker's eventfd if the worker is asleep, so a
+ * burst of frames costs one wake up and no allocation.  The driver thread
+ * runs while any worker is running, so workers can be replaced one at a
+ * time when the configuration changes.
+ *
+ * An ODB-II definition only registers its PID with the shared ODB-II
+ * scheduler, which batches the requests and decodes the responses, and
+ * keeps the bus connected while it runs, with no thread of its own.  The
+ * requests are passed to the transmit thread through one shared queue,
+ * which the transmit thread blocks on.
+ */
+class WdtDioCanInterface: public tmx::utils::ThreadWorker {
 public:
 	static constexpr const char *TaskName = "WDT_DIO";
 
 	WdtDioCanInterface(const tmx::message &);
 	virtual ~WdtDioCanInterface();
 
-	bool accept(const std::shared_ptr<CAN_MSG> &canMsg);
-	void doWork(std::shared_ptr<CAN_MSG> &canMsg);
+	bool accept(const CAN_MSG &canMsg);
+	void doWork(const WdtDioCanFrame &frame);
 	void idle();
-	void notify();
+
+	/**
+	 * Queue a received frame for the worker.  Only called from the driver callback.
+	 */
+	void Received(const CAN_MSG &canMsg, uint64_t time);
 
 	void Start();
 	void Stop();
 
 	DWORD CanId();
+
+	uint64_t get_Dropped() const { return _dropped; }
+protected:
+	void DoWork();
 private:
 	CanDataAdaptor _canData;
+	CanDecoder _decoder;
 	DWORD myId { 0 };
 
-	tmx::utils::ThreadWorker *mgrThread = NULL;
-	tmx::utils::FrequencyThrottle<int> _throttle;
+	// The registration with the ODB-II scheduler, or zero
+	ODBII::ODBIIScheduler::handle_type _odbHandle { 0 };
+
+	// Receiving frames from the driver callback
+	bool _registered = false;
+
+	SpscRing<WdtDioCanFrame, 64> _rxRing;
+
+	// Signaled by the callback when frames are queued while the worker sleeps
+	int _wakeFd { -1 };
+	std::atomic<bool> _sleeping { false };
+
+	// Frames lost because the ring was full
+	std::atomic<uint64_t> _dropped { 0 };
 
-	std::condition_variable _cv;
-	std::mutex _lock;
+	void Sleep(int timeoutMs);
 };
 
 } /* namespace Can */
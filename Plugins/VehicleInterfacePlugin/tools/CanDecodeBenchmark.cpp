@@ -0,0 +1,191 @@
+/*
+ * CanDecodeBenchmark.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "../src/VehicleState.h"
+#include "../src/workers/CanData.hpp"
+#include "../src/workers/CanDecoder.hpp"
+#include "../src/workers/CanLogReader.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace tmx;
+using namespace tmx::messages;
+using namespace VehicleInterfacePlugin;
+using namespace VehicleInterfacePlugin::Can;
+
+typedef std::chrono::steady_clock bench_clock;
+
+static void Usage(const char *name)
+{
+	cerr << "Usage: " << name << " [-n iterations] [-l candump.log] vehicle.json..." << endl;
+	cerr << endl;
+	cerr << "Reports the decode throughput and vehicle message cost of every CAN" << endl;
+	cerr << "definition in the vehicle files.  Random frames are used unless a log" << endl;
+	cerr << "is given, in which case only the logged frames for each id are decoded." << endl;
+}
+
+static double Elapsed(bench_clock::time_point start)
+{
+	return std::chrono::duration<double>(bench_clock::now() - start).count();
+}
+
+/**
+ * Time one definition against its frames
+ */
+static void Benchmark(const string &file, CanDataAdaptor &canData, const vector<CanLogFrame> &frames, size_t iterations)
+{
+	CanDecoder decoder(canData);
+	if (decoder.empty() || frames.empty())
+		return;
+
+	decoder.Bind(VehicleState::GetState());
+
+	// Decoded straight into the vehicle state, as the workers do, with a
+	// receive time as the kernel would supply
+	uint64_t time = VehicleState::Now();
+	bench_clock::time_point start = bench_clock::now();
+	for (size_t i = 0; i < iterations; i++)
+	{
+		const CanLogFrame &frame = frames[i % frames.size()];
+		decoder.Update(frame.data, frame.len, time);
+	}
+	double update = Elapsed(start);
+
+	// A vehicle basic message built for each frame
+	size_t vbmIterations = iterations / 10 + 1;
+	start = bench_clock::now();
+	for (size_t i = 0; i < vbmIterations; i++)
+	{
+		const CanLogFrame &frame = frames[i % frames.size()];
+		VehicleBasicMessage vbm = decoder.decode_VBM(frame.data, frame.len);
+	}
+	double vbm = Elapsed(start);
+
+	printf("%-16s %-28s %4zu %12.0f %10.1f %10.2f\n", file.c_str(), canData.get_name().c_str(), decoder.size(),
+			iterations / update, update * 1e9 / iterations, vbm * 1e6 / vbmIterations);
+}
+
+int main(int argc, char *argv[])
+{
+	size_t iterations = 1000000;
+	string logFile;
+	vector<string> files;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+			iterations = strtoul(argv[++i], NULL, 0);
+		else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc)
+			logFile = argv[++i];
+		else if (argv[i][0] == '-')
+		{
+			Usage(argv[0]);
+			return 1;
+		}
+		else
+			files.push_back(argv[i]);
+	}
+
+	if (files.empty() || iterations == 0)
+	{
+		Usage(argv[0]);
+		return 1;
+	}
+
+	vector<CanLogFrame> logged;
+	if (!logFile.empty())
+	{
+		CanLogReader reader;
+		if (!reader.Open(logFile))
+		{
+			cerr << "Unable to open " << logFile << endl;
+			return 1;
+		}
+
+		CanLogFrame frame;
+		while (reader.Next(frame))
+			logged.push_back(frame);
+
+		cerr << "Read " << logged.size() << " frames from " << logFile << endl;
+	}
+
+	printf("%-16s %-28s %4s %12s %10s %10s\n", "File", "Definition", "Sigs", "Frames/s", "ns/frame", "us/VBM");
+
+	mt19937 generator(1);
+
+	for (auto &file : files)
+	{
+		message_container_type c;
+		try
+		{
+			c.load<JSON>(file);
+		}
+		catch (exception &ex)
+		{
+			cerr << "Unable to load " << file << ": " << ex.what() << endl;
+			continue;
+		}
+
+		message vehicle(c);
+		string name = vehicle.get_untyped("name", file);
+
+		for (auto &canData : vehicle.get_array<CanDataAdaptor>("can"))
+		{
+			if (!canData.get_enabled())
+				continue;
+
+			vector<CanLogFrame> frames;
+
+			if (logged.empty())
+			{
+				// Any bytes will do to exercise the decoder
+				frames.resize(256);
+				for (auto &frame : frames)
+				{
+					frame.len = 8;
+					for (int i = 0; i < frame.len; i++)
+						frame.data[i] = generator();
+				}
+			}
+			else
+			{
+				canid_t mask = MaskByName(canData.get_mask());
+				canid_t id = strtoul(canData.get_id().c_str(), NULL, 0) & mask;
+
+				for (auto &frame : logged)
+				{
+					if ((frame.id & mask) == id)
+						frames.push_back(frame);
+				}
+			}
+
+			Benchmark(name, canData, frames, iterations);
+		}
+	}
+
+	// The cost of building the vehicle message from everything decoded
+	message_tree_type tree;
+	bench_clock::time_point start = bench_clock::now();
+	size_t serializeIterations = iterations / 100 + 1;
+	size_t values = 0;
+	for (size_t i = 0; i < serializeIterations; i++)
+	{
+		tree.clear();
+		values = VehicleState::GetState().Serialize(tree);
+	}
+
+	printf("\nVehicle state: %zu values serialized in %.2f us\n", values, Elapsed(start) * 1e6 / serializeIterations);
+
+	return 0;
+}
@@ -0,0 +1,383 @@
+/*
+ * DbcImport.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+using boost::property_tree::ptree;
+
+#define DBC_EXTENDED_ID 0x80000000U
+
+struct DbcSignal {
+	string name;
+	string comment;
+	int startBit = 0;
+	int bitLen = 0;
+	bool motorola = false;
+	bool isSigned = false;
+	bool multiplexer = false;
+	int mux = -1;
+	double scale = 1.0;
+	double offset = 0.0;
+	string unit;
+
+	// Raw value to description
+	vector<pair<string, string> > states;
+};
+
+struct DbcMessage {
+	uint32_t id = 0;
+	string name;
+	string comment;
+	vector<DbcSignal> signals;
+};
+
+static void Usage(const char *name)
+{
+	cerr << "Usage: " << name << " [-n vehicle] [-o vehicle.json] file.dbc" << endl;
+	cerr << endl;
+	cerr << "Converts the messages and signals of a DBC file to a vehicle definition" << endl;
+	cerr << "for the VehicleInterfacePlugin.  Each signal becomes a bit-level CAN" << endl;
+	cerr << "element, and the signal value tables become enumeration states." << endl;
+}
+
+/**
+ * Read a double quoted string, starting from the current stream position
+ */
+static string Quoted(istream &in)
+{
+	string str;
+	char c;
+
+	in >> ws;
+	if (in.peek() != '"')
+		return str;
+
+	in.get(c);
+	while (in.get(c) && c != '"')
+	{
+		if (c == '\\' && in.get(c))
+			str.push_back(c);
+		else
+			str.push_back(c);
+	}
+
+	return str;
+}
+
+/**
+ * Parse a signal line of the form:
+ *
+ *   SG_ name [M|mN] : start|len@order sign (scale,offset) [min|max] "unit" receivers
+ */
+static bool ParseSignal(const string &line, DbcSignal &signal)
+{
+	size_t colon = line.find(':');
+	if (colon == string::npos)
+		return false;
+
+	istringstream head(line.substr(0, colon));
+	string tag, mux;
+	head >> tag >> signal.name >> mux;
+	if (signal.name.empty())
+		return false;
+
+	if (mux == "M")
+		signal.multiplexer = true;
+	else if (mux.size() > 1 && mux[0] == 'm')
+		signal.mux = atoi(mux.c_str() + 1);
+
+	char order, sign;
+	if (sscanf(line.c_str() + colon + 1, " %d|%d@%c%c (%lf,%lf)", &signal.startBit, &signal.bitLen,
+			&order, &sign, &signal.scale, &signal.offset) != 6)
+		return false;
+
+	signal.motorola = (order == '0');
+	signal.isSigned = (sign == '-');
+
+	size_t quote = line.find('"', colon);
+	if (quote != string::npos)
+	{
+		istringstream unit(line.substr(quote));
+		signal.unit = Quoted(unit);
+	}
+
+	return true;
+}
+
+static DbcSignal *FindSignal(map<uint32_t, DbcMessage> &messages, uint32_t id, const string &name)
+{
+	auto msg = messages.find(id);
+	if (msg == messages.end())
+		return NULL;
+
+	for (auto &signal: msg->second.signals)
+		if (signal.name == name)
+			return &signal;
+
+	return NULL;
+}
+
+static bool IsIntegral(double value)
+{
+	return value == std::floor(value);
+}
+
+/**
+ * @return The number as text, without the noise of the full double precision
+ */
+static string Number(double value)
+{
+	char buf[32];
+	snprintf(buf, sizeof(buf), "%.15g", value);
+	return buf;
+}
+
+static ptree Element(const DbcSignal &signal)
+{
+	ptree element;
+
+	element.put("name", signal.name);
+	if (!signal.comment.empty())
+		element.put("comment", signal.comment);
+
+	// The state values are raw, so enumerations are never scaled
+	if (!signal.states.empty())
+		element.put("datatype", "enum");
+	else if (IsIntegral(signal.scale) && IsIntegral(signal.offset))
+		element.put("datatype", "int");
+	else
+		element.put("datatype", "double");
+
+	if (!signal.unit.empty())
+		element.put("unit", signal.unit);
+
+	element.put("startbit", signal.startBit);
+	element.put("bitlen", signal.bitLen);
+	element.put("order", signal.motorola ? "motorola" : "intel");
+
+	if (signal.isSigned)
+		element.put("signedval", true);
+
+	if (signal.multiplexer)
+		element.put("multiplexer", true);
+	else if (signal.mux >= 0)
+		element.put("mux", signal.mux);
+
+	if (signal.states.empty())
+	{
+		if (signal.scale != 1.0)
+			element.put("scale", Number(signal.scale));
+		if (signal.offset != 0.0)
+			element.put("adjust", Number(signal.offset));
+	}
+	else
+	{
+		// The descriptions may contain the path separator, so add directly
+		ptree states;
+		for (auto &state: signal.states)
+			states.push_back(ptree::value_type(state.second, ptree(state.first)));
+
+		element.add_child("states", states);
+	}
+
+	return element;
+}
+
+int main(int argc, char *argv[])
+{
+	string vehicle;
+	string output;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "n:o:h")) != -1)
+	{
+		switch (opt)
+		{
+		case 'n':
+			vehicle = optarg;
+			break;
+		case 'o':
+			output = optarg;
+			break;
+		default:
+			Usage(argv[0]);
+			return opt == 'h' ? 0 : 1;
+		}
+	}
+
+	if (optind != argc - 1)
+	{
+		Usage(argv[0]);
+		return 1;
+	}
+
+	string file = argv[optind];
+	ifstream in(file);
+	if (!in)
+	{
+		cerr << "Unable to open " << file << endl;
+		return 1;
+	}
+
+	if (vehicle.empty())
+	{
+		vehicle = file.substr(file.find_last_of('/') + 1);
+		vehicle = vehicle.substr(0, vehicle.find_last_of('.'));
+	}
+
+	map<uint32_t, DbcMessage> messages;
+	DbcMessage *current = NULL;
+	size_t lineNum = 0;
+
+	string line;
+	while (getline(in, line))
+	{
+		lineNum++;
+
+		istringstream is(line);
+		string tag;
+		is >> tag;
+
+		// Comments may span lines, so read up to the closing quote
+		if (tag == "CM_")
+		{
+			string more;
+			while (count(line.begin(), line.end(), '"') % 2 && getline(in, more))
+			{
+				lineNum++;
+				line += "\n" + more;
+			}
+
+			is.clear();
+			is.str(line);
+			is >> tag;
+		}
+
+		if (tag == "BO_")
+		{
+			DbcMessage msg;
+			string name;
+			is >> msg.id >> name;
+			msg.name = name.substr(0, name.find(':'));
+
+			current = &(messages[msg.id] = msg);
+		}
+		else if (tag == "SG_")
+		{
+			DbcSignal signal;
+			if (current && ParseSignal(line, signal))
+				current->signals.push_back(signal);
+			else
+				cerr << file << ":" << lineNum << ": Ignoring signal" << endl;
+		}
+		else if (tag == "CM_")
+		{
+			string type;
+			uint32_t id;
+			is >> type;
+
+			if (type == "BO_" && is >> id && messages.count(id))
+			{
+				messages[id].comment = Quoted(is);
+			}
+			else if (type == "SG_" && is >> id)
+			{
+				string name;
+				is >> name;
+
+				DbcSignal *signal = FindSignal(messages, id, name);
+				if (signal)
+					signal->comment = Quoted(is);
+			}
+		}
+		else if (tag == "VAL_")
+		{
+			uint32_t id;
+			string name;
+			is >> id >> name;
+
+			DbcSignal *signal = FindSignal(messages, id, name);
+			if (!signal)
+				continue;
+
+			string value;
+			while (is >> value && value != ";")
+				signal->states.push_back(make_pair(value, Quoted(is)));
+		}
+		else if (!tag.empty() && tag != "VERSION" && tag != "NS_" && tag != "BS_" && tag != "BU_")
+		{
+			current = NULL;
+		}
+	}
+
+	ptree tree;
+	tree.put("name", vehicle);
+	tree.put("comment", "Imported from " + file);
+
+	ptree can;
+	size_t numSignals = 0;
+	for (auto &entry: messages)
+	{
+		DbcMessage &msg = entry.second;
+		if (msg.signals.empty())
+			continue;
+
+		char id[16];
+		snprintf(id, sizeof(id), "0x%X", msg.id & ~DBC_EXTENDED_ID);
+
+		ptree canData;
+		canData.put("name", msg.name);
+		if (!msg.comment.empty())
+			canData.put("comment", msg.comment);
+		canData.put("id", id);
+		canData.put("mask", (msg.id & DBC_EXTENDED_ID) ? "EFF" : "SFF");
+
+		ptree elements;
+		for (auto &signal: msg.signals)
+		{
+			elements.push_back(ptree::value_type("", Element(signal)));
+			numSignals++;
+		}
+
+		canData.add_child("elements", elements);
+		can.push_back(ptree::value_type("", canData));
+	}
+
+	tree.add_child("can", can);
+
+	if (output.empty())
+	{
+		boost::property_tree::write_json(cout, tree);
+	}
+	else
+	{
+		ofstream out(output);
+		if (!out)
+		{
+			cerr << "Unable to write " << output << endl;
+			return 1;
+		}
+
+		boost::property_tree::write_json(out, tree);
+	}
+
+	cerr << "Imported " << numSignals << " signals in " << can.size() << " messages from " << file << endl;
+	return 0;
+}
@@ -0,0 +1,155 @@
+/*
+ * ODBIIBenchmark.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "WdtDioSimulator.hpp"
+#include "../src/VehicleState.h"
+#include "../src/workers/CanBusStatistics.hpp"
+#include "../src/workers/CanData.hpp"
+#include "../src/workers/WdtDioCanInterface.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace tmx;
+using namespace VehicleInterfacePlugin;
+using namespace VehicleInterfacePlugin::Can;
+using namespace VehicleInterfacePlugin::Simulator;
+
+namespace VehicleInterfacePlugin {
+
+// The plugin is not linked in, so there is nowhere to send the messages
+void VehicleConnection::BroadcastMessage(tmx::messages::VehicleBasicMessage &msg) { }
+
+} /* End namespace VehicleInterfacePlugin */
+
+static void Usage(const char *name)
+{
+	cerr << "Usage: " << name << " [-d seconds] [-l latency] [-j jitter] [-p pid=latency]... [-x loss] vehicle.json..." << endl;
+	cerr << endl;
+	cerr << "Runs the ODB-II definitions in the vehicle files through the WDT_DIO" << endl;
+	cerr << "interface against a simulated ECU, and reports the request rate and the" << endl;
+	cerr << "response latency of each PID.  Latencies are in milliseconds, and the" << endl;
+	cerr << "loss is the fraction of requests the ECU ignores." << endl;
+}
+
+static chrono::microseconds Milliseconds(const char *value)
+{
+	return chrono::microseconds(static_cast<int64_t>(strtod(value, NULL) * 1000));
+}
+
+int main(int argc, char *argv[])
+{
+	double duration = 10;
+	vector<string> files;
+
+	WdtDioSimulator &sim = WdtDioSimulator::Get();
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-d") == 0 && i + 1 < argc)
+			duration = strtod(argv[++i], NULL);
+		else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc)
+			sim.set_Latency(Milliseconds(argv[++i]));
+		else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+			sim.set_Jitter(Milliseconds(argv[++i]));
+		else if (strcmp(argv[i], "-x") == 0 && i + 1 < argc)
+			sim.set_LossRate(strtod(argv[++i], NULL));
+		else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc)
+		{
+			char *latency = NULL;
+			unsigned long pid = strtoul(argv[++i], &latency, 0);
+			if (pid > 0xFF || !latency || *latency != '=')
+			{
+				Usage(argv[0]);
+				return 1;
+			}
+
+			sim.set_Latency(pid, Milliseconds(latency + 1));
+		}
+		else if (argv[i][0] == '-')
+		{
+			Usage(argv[0]);
+			return 1;
+		}
+		else
+			files.push_back(argv[i]);
+	}
+
+	if (files.empty() || duration <= 0)
+	{
+		Usage(argv[0]);
+		return 1;
+	}
+
+	vector<WdtDioCanInterface *> workers;
+	for (auto &file : files)
+	{
+		message_container_type c;
+		try
+		{
+			c.load<JSON>(file);
+		}
+		catch (exception &ex)
+		{
+			cerr << "Unable to load " << file << ": " << ex.what() << endl;
+			continue;
+		}
+
+		message vehicle(c);
+		for (auto &canData : vehicle.get_array<CanDataAdaptor>("can"))
+		{
+			if (canData.get_enabled() && canData.get_type() == ODB_TYPE::ODBII)
+				workers.push_back(new WdtDioCanInterface(canData));
+		}
+	}
+
+	if (workers.empty())
+	{
+		cerr << "No ODB-II definitions found" << endl;
+		return 1;
+	}
+
+	cerr << "Requesting " << workers.size() << " ODB-II PIDs for " << duration << " seconds" << endl;
+
+	for (auto worker : workers)
+		worker->Start();
+
+	uint64_t updates = VehicleState::GetState().get_Updates();
+	auto start = chrono::steady_clock::now();
+	this_thread::sleep_for(chrono::duration<double>(duration));
+	double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	updates = VehicleState::GetState().get_Updates() - updates;
+	auto stats = CanBusStatistics::ForBus("wdt_dio");
+	string bus = stats->Summary();
+
+	for (auto worker : workers)
+		delete worker;
+
+	printf("%-6s %10s %10s %10s %10s %10s %10s\n", "PID", "Requests", "Responses", "Req/s", "Mean ms", "Min ms", "Max ms");
+	for (auto &entry : sim.get_PidStats())
+	{
+		const WdtDioSimulator::PidStats &pid = entry.second;
+		printf("0x%02X   %10llu %10llu %10.1f %10.3f %10.3f %10.3f\n", entry.first,
+				(unsigned long long)pid.requests, (unsigned long long)pid.responses, pid.requests / elapsed,
+				pid.responses ? pid.totalLatency * 1000 / pid.responses : 0, pid.minLatency * 1000, pid.maxLatency * 1000);
+	}
+
+	printf("\n%llu requests (%.1f/s), %llu responses, %llu lost, %llu frames, %llu values decoded\n",
+			(unsigned long long)sim.get_Requests(), sim.get_Requests() / elapsed,
+			(unsigned long long)sim.get_Responses(), (unsigned long long)sim.get_Lost(),
+			(unsigned long long)sim.get_Frames(), (unsigned long long)updates);
+	printf("Bus: %s\n", bus.c_str());
+
+	return 0;
+}
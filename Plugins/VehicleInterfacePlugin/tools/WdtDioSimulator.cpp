@@ -0,0 +1,426 @@
+/*
+ * WdtDioSimulator.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "WdtDioSimulator.hpp"
+#include "../src/workers/CanBusStatistics.hpp"
+#include "../src/workers/ODBIIScheduler.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+// The functional broadcast and physical request addresses, and the response address of the ECU
+#define ECU_BROADCAST 0x7DF
+#define ECU_REQUEST 0x7E0
+#define ECU_RESPONSE 0x7E8
+
+// Filler for the unused bytes of a frame
+#define ECU_PAD 0x55
+
+using namespace std;
+using namespace VehicleInterfacePlugin::Can;
+
+namespace VehicleInterfacePlugin {
+namespace Simulator {
+
+WdtDioSimulator &WdtDioSimulator::Get()
+{
+	static WdtDioSimulator _sim;
+	return _sim;
+}
+
+WdtDioSimulator::WdtDioSimulator(): _random(1)
+{
+	for (auto &latency: _pidLatency)
+		latency = chrono::microseconds(-1);
+}
+
+WdtDioSimulator::~WdtDioSimulator()
+{
+	Stop();
+}
+
+void WdtDioSimulator::set_Latency(chrono::microseconds latency)
+{
+	lock_guard<mutex> lock(_lock);
+	_latency = latency;
+}
+
+void WdtDioSimulator::set_Latency(uint8_t pid, chrono::microseconds latency)
+{
+	lock_guard<mutex> lock(_lock);
+	_pidLatency[pid] = latency;
+}
+
+void WdtDioSimulator::set_Jitter(chrono::microseconds jitter)
+{
+	lock_guard<mutex> lock(_lock);
+	_jitter = jitter;
+}
+
+void WdtDioSimulator::set_LossRate(double rate)
+{
+	lock_guard<mutex> lock(_lock);
+	_lossRate = rate;
+}
+
+map<uint8_t, WdtDioSimulator::PidStats> WdtDioSimulator::get_PidStats()
+{
+	lock_guard<mutex> lock(_lock);
+	return _stats;
+}
+
+void WdtDioSimulator::Reset()
+{
+	lock_guard<mutex> lock(_lock);
+	_stats.clear();
+	_requests = 0;
+	_responses = 0;
+	_lost = 0;
+	_frames = 0;
+}
+
+bool WdtDioSimulator::RegisterReceived(void (__stdcall *handler)(CAN_MSG *, DWORD))
+{
+	lock_guard<mutex> lock(_lock);
+	_received = handler;
+	return true;
+}
+
+bool WdtDioSimulator::RegisterStatus(void (__stdcall *handler)(DWORD))
+{
+	lock_guard<mutex> lock(_lock);
+	_status = handler;
+	return true;
+}
+
+bool WdtDioSimulator::Setup(const CAN_SETUP &setup)
+{
+	lock_guard<mutex> lock(_lock);
+
+	// A full standard frame, without the stuff bits
+	uint64_t bitRate = setup.bitRate > 0 ? setup.bitRate : 500000;
+	_frameTime = chrono::microseconds(CanBusStatistics::FrameBits(false, 8) * 1000000 / bitRate);
+	return true;
+}
+
+bool WdtDioSimulator::Start()
+{
+	lock_guard<mutex> lock(_lock);
+	if (_running || !_received)
+		return false;
+
+	_running = true;
+	_thread = thread(&WdtDioSimulator::Run, this);
+	return true;
+}
+
+bool WdtDioSimulator::Stop()
+{
+	{
+		lock_guard<mutex> lock(_lock);
+		if (!_running)
+			return false;
+
+		_running = false;
+	}
+
+	_cv.notify_all();
+	if (_thread.joinable())
+		_thread.join();
+
+	lock_guard<mutex> lock(_lock);
+	_pending.clear();
+	_due.clear();
+	_transfer.reset();
+	_backlog.clear();
+	return true;
+}
+
+bool WdtDioSimulator::Send(const CAN_MSG &msg)
+{
+	clock_type::time_point now = clock_type::now();
+
+	lock_guard<mutex> lock(_lock);
+	if (!_running)
+		return false;
+
+	uint8_t type = msg.data[0] >> 4;
+	if ((msg.id == ECU_BROADCAST || msg.id == ECU_REQUEST) && type == 0)
+		Request(msg, now);
+	else if (msg.id == ECU_REQUEST && type == 3)
+		FlowControl(msg, now);
+
+	_cv.notify_all();
+	return true;
+}
+
+void WdtDioSimulator::Request(const CAN_MSG &msg, clock_type::time_point now)
+{
+	size_t len = min<size_t>(msg.data[0] & 0x0F, msg.len - 1);
+	if (len < 2 || msg.data[1] != 0x01)
+		return;
+
+	_requests++;
+
+	shared_ptr<Response> response(new Response());
+	response->requested = now;
+	response->payload.push_back(0x41);
+
+	chrono::microseconds latency(0);
+	for (size_t i = 2; i <= len; i++)
+	{
+		uint8_t pid = msg.data[i];
+		_stats[pid].requests++;
+
+		// Unsupported PIDs are left out of the response
+		uint8_t n = ODBII::ODBIIScheduler::PidLength(pid);
+		if (n == 0)
+			continue;
+
+		response->pids.push_back(pid);
+		response->payload.push_back(pid);
+		Value(pid, n, response->payload);
+
+		latency = max(latency, _pidLatency[pid].count() >= 0 ? _pidLatency[pid] : _latency);
+	}
+
+	// No response at all if nothing is supported
+	if (response->pids.empty())
+		return;
+
+	if (_lossRate > 0 && uniform_real_distribution<double>(0, 1)(_random) < _lossRate)
+	{
+		_lost++;
+		return;
+	}
+
+	if (_jitter.count() > 0)
+		latency += chrono::microseconds(uniform_int_distribution<int64_t>(0, _jitter.count())(_random));
+
+	_pending.insert(make_pair(now + latency, response));
+}
+
+void WdtDioSimulator::Value(uint8_t pid, uint8_t length, vector<uint8_t> &payload)
+{
+	if (pid % 0x20 == 0)
+	{
+		// The bits for the next 32 PIDs that this ECU supports
+		uint32_t supported = 0;
+		for (int i = 0; i < 32; i++)
+		{
+			if (pid + 1 + i < 256 && ODBII::ODBIIScheduler::PidLength(pid + 1 + i) > 0)
+				supported |= (1U << (31 - i));
+		}
+
+		for (int shift = 24; shift >= 0; shift -= 8)
+			payload.push_back((supported >> shift) & 0xFF);
+		return;
+	}
+
+	// Values that change with every response
+	for (uint8_t i = 0; i < length; i++)
+		payload.push_back(_counter + i);
+
+	_counter++;
+}
+
+void WdtDioSimulator::Respond(shared_ptr<Response> response, clock_type::time_point now)
+{
+	Frame frame;
+	memset(&frame.msg, 0, sizeof(frame.msg));
+	memset(frame.msg.data, ECU_PAD, sizeof(frame.msg.data));
+	frame.msg.id = ECU_RESPONSE;
+	frame.msg.len = sizeof(frame.msg.data);
+
+	size_t size = response->payload.size();
+	if (size <= 7)
+	{
+		frame.msg.data[0] = size;
+		memcpy(&frame.msg.data[1], response->payload.data(), size);
+		frame.response = response;
+
+		_due.insert(make_pair(now, frame));
+		return;
+	}
+
+	// Only one transfer at a time, so the rest wait their turn
+	if (_transfer)
+	{
+		_backlog.push_back(response);
+		return;
+	}
+
+	_transfer = response;
+
+	frame.msg.data[0] = 0x10 | ((size >> 8) & 0x0F);
+	frame.msg.data[1] = size & 0xFF;
+	memcpy(&frame.msg.data[2], response->payload.data(), 6);
+
+	_due.insert(make_pair(now, frame));
+}
+
+void WdtDioSimulator::FlowControl(const CAN_MSG &msg, clock_type::time_point now)
+{
+	if (!_transfer)
+		return;
+
+	// The separation time is in milliseconds, or hundreds of microseconds from 0xF1 to 0xF9
+	uint8_t stMin = msg.data[2];
+	chrono::microseconds separation(0);
+	if (stMin <= 0x7F)
+		separation = chrono::milliseconds(stMin);
+	else if (stMin >= 0xF1 && stMin <= 0xF9)
+		separation = chrono::microseconds(100 * (stMin - 0xF0));
+
+	separation = max(separation, _frameTime);
+
+	shared_ptr<Response> response = _transfer;
+	_transfer.reset();
+
+	const vector<uint8_t> &payload = response->payload;
+	clock_type::time_point when = now;
+	uint8_t seq = 1;
+	for (size_t offset = 6; offset < payload.size(); offset += 7)
+	{
+		Frame frame;
+		memset(&frame.msg, 0, sizeof(frame.msg));
+		memset(frame.msg.data, ECU_PAD, sizeof(frame.msg.data));
+		frame.msg.id = ECU_RESPONSE;
+		frame.msg.len = sizeof(frame.msg.data);
+
+		size_t n = min<size_t>(7, payload.size() - offset);
+		frame.msg.data[0] = 0x20 | seq;
+		memcpy(&frame.msg.data[1], &payload[offset], n);
+		seq = (seq + 1) & 0x0F;
+
+		when += separation;
+		if (offset + n >= payload.size())
+			frame.response = response;
+
+		_due.insert(make_pair(when, frame));
+	}
+
+	// The next transfer starts after the last frame of this one
+	if (!_backlog.empty())
+	{
+		shared_ptr<Response> next = _backlog.front();
+		_backlog.pop_front();
+		Respond(next, when + _frameTime);
+	}
+}
+
+void WdtDioSimulator::Deliver(Frame &frame, unique_lock<mutex> &lock)
+{
+	void (__stdcall *received)(CAN_MSG *, DWORD) = _received;
+
+	// The callback may queue the next request or flow control
+	lock.unlock();
+
+	_frames++;
+	if (received)
+		received(&frame.msg, sizeof(CAN_MSG));
+
+	clock_type::time_point done = clock_type::now();
+
+	lock.lock();
+
+	if (!frame.response)
+		return;
+
+	_responses++;
+
+	double latency = chrono::duration<double>(done - frame.response->requested).count();
+	for (uint8_t pid: frame.response->pids)
+	{
+		PidStats &stats = _stats[pid];
+		if (stats.responses == 0 || latency < stats.minLatency)
+			stats.minLatency = latency;
+		if (latency > stats.maxLatency)
+			stats.maxLatency = latency;
+
+		stats.responses++;
+		stats.totalLatency += latency;
+	}
+}
+
+void WdtDioSimulator::Run()
+{
+	unique_lock<mutex> lock(_lock);
+
+	if (_status)
+	{
+		void (__stdcall *status)(DWORD) = _status;
+		lock.unlock();
+		status(0);
+		lock.lock();
+	}
+
+	while (_running)
+	{
+		clock_type::time_point now = clock_type::now();
+
+		// Start the responses that are due
+		while (!_pending.empty() && _pending.begin()->first <= now)
+		{
+			shared_ptr<Response> response = _pending.begin()->second;
+			_pending.erase(_pending.begin());
+			Respond(response, now);
+		}
+
+		if (!_due.empty() && _due.begin()->first <= now)
+		{
+			Frame frame = _due.begin()->second;
+			_due.erase(_due.begin());
+			Deliver(frame, lock);
+			continue;
+		}
+
+		clock_type::time_point next = now + chrono::milliseconds(100);
+		if (!_pending.empty())
+			next = min(next, _pending.begin()->first);
+		if (!_due.empty())
+			next = min(next, _due.begin()->first);
+
+		_cv.wait_until(lock, next);
+	}
+}
+
+} /* End namespace Simulator */
+} /* End namespace VehicleInterfacePlugin */
+
+using namespace VehicleInterfacePlugin::Simulator;
+
+// Only CAN port 0 is simulated
+
+BOOL __cdecl CAN_RegisterReceived(DWORD idx, void (__stdcall *pfnHandler)(CAN_MSG *lpMsg, DWORD cbMsg))
+{
+	return idx == 0 && WdtDioSimulator::Get().RegisterReceived(pfnHandler);
+}
+
+BOOL __cdecl CAN_RegisterStatus(DWORD idx, void (__stdcall *pfnHandler)(DWORD status))
+{
+	return idx == 0 && WdtDioSimulator::Get().RegisterStatus(pfnHandler);
+}
+
+BOOL __cdecl CAN_Setup(DWORD idx, CAN_SETUP *lpSetup, DWORD cbSetup)
+{
+	return idx == 0 && lpSetup && cbSetup >= sizeof(CAN_SETUP) && WdtDioSimulator::Get().Setup(*lpSetup);
+}
+
+BOOL __cdecl CAN_Start(DWORD idx)
+{
+	return idx == 0 && WdtDioSimulator::Get().Start();
+}
+
+BOOL __cdecl CAN_Stop(DWORD idx)
+{
+	return idx == 0 && WdtDioSimulator::Get().Stop();
+}
+
+BOOL __cdecl CAN_Send(DWORD idx, CAN_MSG *lpMsg, DWORD cbMsg)
+{
+	return idx == 0 && lpMsg && cbMsg >= sizeof(CAN_MSG) && WdtDioSimulator::Get().Send(*lpMsg);
+}
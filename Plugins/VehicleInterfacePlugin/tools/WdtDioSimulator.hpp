@@ -0,0 +1,154 @@
+/*
+ * WdtDioSimulator.hpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef TOOLS_WDTDIOSIMULATOR_HPP_
+#define TOOLS_WDTDIOSIMULATOR_HPP_
+
+#include <wdt_dio.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace VehicleInterfacePlugin {
+namespace Simulator {
+
+/**
+ * A stand-in for the CAN functions of the Neousys WDT_DIO library, with one
+ * simulated ECU on the bus that answers ODB-II mode 01 requests.
+ *
+ * Linking this in place of the real library lets the WdtDioCanInterface and
+ * the ODB-II scheduler run unchanged on a machine with no CAN hardware.  The
+ * ECU answers each request after a configurable latency, which may be set per
+ * PID, and sends the responses that do not fit in one frame with ISO-TP, only
+ * after the flow control from the requester.  The frames of a response are
+ * spaced by the time they would take on the bus.
+ *
+ * The latency of each PID is measured from the request until the driver
+ * callback for the last frame of the response returns, by which time the
+ * value has been decoded.
+ */
+class WdtDioSimulator {
+public:
+	typedef std::chrono::steady_clock clock_type;
+
+	struct PidStats {
+		uint64_t requests = 0;
+		uint64_t responses = 0;
+		double totalLatency = 0;
+		double minLatency = 0;
+		double maxLatency = 0;
+	};
+
+	static WdtDioSimulator &Get();
+
+	/**
+	 * Set the response latency for all the PIDs with no latency of their own
+	 */
+	void set_Latency(std::chrono::microseconds latency);
+	void set_Latency(uint8_t pid, std::chrono::microseconds latency);
+
+	/**
+	 * Set the most that is randomly added to each latency
+	 */
+	void set_Jitter(std::chrono::microseconds jitter);
+
+	/**
+	 * Set the fraction of requests that are never answered
+	 */
+	void set_LossRate(double rate);
+
+	/**
+	 * @return The statistics of each mode 01 PID that was requested, in seconds
+	 */
+	std::map<uint8_t, PidStats> get_PidStats();
+
+	uint64_t get_Requests() const { return _requests; }
+	uint64_t get_Responses() const { return _responses; }
+	uint64_t get_Lost() const { return _lost; }
+	uint64_t get_Frames() const { return _frames; }
+
+	void Reset();
+
+	// The CAN functions of the driver
+	bool RegisterReceived(void (__stdcall *handler)(CAN_MSG *, DWORD));
+	bool RegisterStatus(void (__stdcall *handler)(DWORD));
+	bool Setup(const CAN_SETUP &setup);
+	bool Start();
+	bool Stop();
+	bool Send(const CAN_MSG &msg);
+
+private:
+	WdtDioSimulator();
+	~WdtDioSimulator();
+
+	struct Response {
+		clock_type::time_point requested;
+		std::vector<uint8_t> pids;
+		std::vector<uint8_t> payload;
+	};
+
+	struct Frame {
+		CAN_MSG msg;
+
+		// Set on the last frame of a response
+		std::shared_ptr<Response> response;
+	};
+
+	std::mutex _lock;
+	std::condition_variable _cv;
+	std::thread _thread;
+	bool _running = false;
+
+	void (__stdcall *_received)(CAN_MSG *, DWORD) = NULL;
+	void (__stdcall *_status)(DWORD) = NULL;
+
+	std::chrono::microseconds _latency { 5000 };
+	std::chrono::microseconds _jitter { 0 };
+	std::chrono::microseconds _pidLatency[256];
+	double _lossRate = 0;
+	std::mt19937 _random;
+
+	// The bus time of one full frame
+	std::chrono::microseconds _frameTime { 222 };
+
+	// Responses not yet due, and frames ready to deliver, both by time
+	std::multimap<clock_type::time_point, std::shared_ptr<Response> > _pending;
+	std::multimap<clock_type::time_point, Frame> _due;
+
+	// The multi-frame response waiting for flow control, and those queued behind it
+	std::shared_ptr<Response> _transfer;
+	std::deque<std::shared_ptr<Response> > _backlog;
+
+	std::map<uint8_t, PidStats> _stats;
+
+	std::atomic<uint64_t> _requests { 0 };
+	std::atomic<uint64_t> _responses { 0 };
+	std::atomic<uint64_t> _lost { 0 };
+	std::atomic<uint64_t> _frames { 0 };
+
+	uint8_t _counter = 0;
+
+	void Run();
+	void Request(const CAN_MSG &msg, clock_type::time_point now);
+	void Respond(std::shared_ptr<Response> response, clock_type::time_point now);
+	void FlowControl(const CAN_MSG &msg, clock_type::time_point now);
+	void Deliver(Frame &frame, std::unique_lock<std::mutex> &lock);
+	void Value(uint8_t pid, uint8_t length, std::vector<uint8_t> &payload);
+};
+
+} /* End namespace Simulator */
+} /* End namespace VehicleInterfacePlugin */
+
+#endif /* TOOLS_WDTDIOSIMULATOR_HPP_ */